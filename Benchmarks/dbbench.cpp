@@ -0,0 +1,615 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFileInfo>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include "databasemanager.h"
+
+// QBENCHMARK suite over every DatabaseManager call, run once per seeded database size.
+// Reads share one seeded file per size; each write benchmark gets a fresh copy of it, so
+// runs never change the fixture and stay comparable.
+namespace {
+
+const int kStudents = 1000;
+const int kVendors = 20;
+const int kProductsPerShop = 50;
+const int kImportTargetRows = 100000;
+const qint64 kImportTargetMs = 1000;
+const int kArchiveDays = 20;
+
+struct Fixture {
+    int studentId = -1;
+    int vendorId = -1;
+    int shopId = -1;
+    int productId = -1;
+    double productPrice = 0.0;
+    int orderId = -1;
+    QVector<int> productIds;
+};
+
+bool exec(QSqlQuery &query, const QString &sql, const QVariantList &binds = {}) {
+    query.prepare(sql);
+    for (int i = 0; i < binds.size(); ++i) {
+        query.bindValue(i, binds[i]);
+    }
+    if (!query.exec()) {
+        qWarning() << "Seed failed:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+// Bulk seeding in SQL keeps the 1M order database to one statement per table
+bool seed(int orders) {
+    QSqlDatabase db = DatabaseManager::instance().database();
+    QSqlQuery query(db);
+    const QString series = "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < ?) ";
+
+    db.transaction();
+    bool ok = exec(query, series + "INSERT INTO users (username, password, user_type) "
+                                   "SELECT 'bench_student' || i, 'pass123', 'student' FROM n", {kStudents})
+              && exec(query, series + "INSERT INTO users (username, password, user_type) "
+                                      "SELECT 'bench_vendor' || i, 'pass123', 'vendor' FROM n", {kVendors})
+              && exec(query, "INSERT INTO shops (vendor_id, shop_name, slot_number, description) "
+                             "SELECT id, 'Bench Shop ' || id, 'B' || id, '' FROM users "
+                             "WHERE username LIKE 'bench_vendor%' ORDER BY id")
+              && exec(query, series + "INSERT INTO products (shop_id, name, price, category) "
+                                      "SELECT s.id, 'Bench Item ' || s.id || '-' || n.i, 10 + n.i, 'Bench' "
+                                      "FROM shops s, n WHERE s.shop_name LIKE 'Bench Shop%' "
+                                      "ORDER BY s.id, n.i", {kProductsPerShop});
+    if (!ok) {
+        db.rollback();
+        return false;
+    }
+
+    query.exec("SELECT MIN(id) FROM users WHERE username LIKE 'bench_student%'");
+    query.next();
+    int firstStudent = query.value(0).toInt();
+    query.exec("SELECT MIN(id) FROM shops WHERE shop_name LIKE 'Bench Shop%'");
+    query.next();
+    int firstShop = query.value(0).toInt();
+    query.exec("SELECT COALESCE(MAX(id), 0) FROM orders");
+    query.next();
+    int lastSeedOrder = query.value(0).toInt();
+
+    // Spread over 30 days; 1% pending and 1% preparing like a live board
+    ok = exec(query, series + "INSERT INTO orders (student_id, shop_id, total_amount, status, order_date) "
+                              "SELECT ? + i % ?, ? + i % ?, 50 + i % 200, "
+                              "CASE i % 100 WHEN 0 THEN 'pending' WHEN 1 THEN 'preparing' ELSE 'completed' END, "
+                              "DATETIME('now', '-' || (i * 7 % 2592000) || ' seconds') FROM n",
+              {orders, firstStudent, kStudents, firstShop, kVendors})
+         && exec(query, "INSERT INTO order_items (order_id, product_id, quantity, price) "
+                        "SELECT o.id, (SELECT MIN(id) FROM products WHERE shop_id = o.shop_id) + o.id % ?, "
+                        "1 + o.id % 3, 10 "
+                        "FROM orders o WHERE o.id > ?", {kProductsPerShop, lastSeedOrder});
+    if (!ok) {
+        db.rollback();
+        return false;
+    }
+    return db.commit();
+}
+
+bool loadFixture(Fixture &fixture) {
+    DatabaseManager &db = DatabaseManager::instance();
+    fixture.studentId = db.getUserId("bench_student1");
+    fixture.vendorId = db.getUserId("bench_vendor1");
+    fixture.shopId = db.getShopId(fixture.vendorId);
+    QVector<Product> products = db.getProductsByShop(fixture.shopId);
+    OrderPage page = db.getOrdersByShopPage(fixture.shopId, OrderCursor(), 1);
+    if (fixture.studentId == -1 || fixture.shopId == -1 || products.size() < 5 || page.orders.isEmpty()) {
+        return false;
+    }
+    fixture.productId = products.first().id;
+    fixture.productPrice = products.first().price;
+    fixture.orderId = page.orders.first().id;
+    fixture.productIds.clear();
+    for (int i = 0; i < 5; ++i) {
+        fixture.productIds.append(products[i].id);
+    }
+    return true;
+}
+
+// Calls once first so the statement cache and page cache are warm before timing
+template <typename Func>
+void bench(Func &&call) {
+    call();
+    QBENCHMARK {
+        call();
+    }
+}
+
+}
+
+class DbBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase_data();
+    void initTestCase();
+
+    // Reads, against the shared seeded database
+    void validateLogin();
+    void getUserId();
+    void usernameExists();
+    void getUsername();
+    void getShopId();
+    void getShopName();
+    void getAllShops();
+    void getAllAvailableProducts();
+    void catalog();
+    void searchProducts();
+    void getProductsByShop();
+    void getOrdersByShop();
+    void getOrdersByShopPage();
+    void getOrdersByShopPageCompleted();
+    void getOrdersByStudent();
+    void getOrdersByStudentPage();
+    void getOrderItems();
+    void getOrderChangesSince();
+    void getShopStats();
+    void getTotalRevenue();
+    void getTodayRevenue();
+    void getTotalOrdersCount();
+    void getCompletedOrdersCount();
+    void exportOrders();
+
+    // Writes, each against a fresh copy of the seeded database
+    void registerUser();
+    void registerShop();
+    void addProduct();
+    void updateProductAvailability();
+    void placeOrder_data();
+    void placeOrder();
+    void createOrderAndAddOrderItem();
+    void updateOrderStatus();
+    void saveCartItem();
+    void getSavedCart();
+    void clearSavedCart();
+    void importProducts_data();
+    void importProducts();
+    void archiveCompletedOrders();
+
+private:
+    bool openSeeded();
+    bool openCopy();
+    bool open(const QString &path);
+    QString importFile(int rows);
+
+    QTemporaryDir tempDir;
+    QString seedDir;
+    QString copyPath;
+    int copySerial = 0;
+    Fixture f;
+};
+
+void DbBench::initTestCase_data()
+{
+    // CEG_BENCH_ORDERS=1000,100000 limits the sizes, e.g. for a quick run
+    QTest::addColumn<int>("orders");
+    QString sizes = qEnvironmentVariable("CEG_BENCH_ORDERS", "1000,100000,1000000");
+    for (const QString &size : sizes.split(',', Qt::SkipEmptyParts)) {
+        int orders = size.trimmed().toInt();
+        QString tag = orders % 1000000 == 0 ? QString("%1M").arg(orders / 1000000)
+                    : orders % 1000 == 0    ? QString("%1k").arg(orders / 1000)
+                                            : QString::number(orders);
+        QTest::newRow(qPrintable(tag)) << orders;
+    }
+}
+
+void DbBench::initTestCase()
+{
+    QVERIFY(tempDir.isValid());
+    // CEG_BENCH_DB_DIR keeps the seeded databases between runs, so 1M orders is seeded once
+    seedDir = qEnvironmentVariable("CEG_BENCH_DB_DIR", tempDir.path());
+    QVERIFY(QDir().mkpath(seedDir));
+}
+
+// Written once per row count and shared by every database size
+QString DbBench::importFile(int rows)
+{
+    QString path = tempDir.filePath(QString("import-%1.csv").arg(rows));
+    if (QFileInfo::exists(path)) {
+        return path;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return QString();
+    }
+    QTextStream out(&file);
+    out << "name,price,category,available\n";
+    for (int i = 0; i < rows; ++i) {
+        out << "Imported Item " << i << ',' << 10 + i % 90 << ",Imported," << (i % 10 != 0) << '\n';
+    }
+    return path;
+}
+
+bool DbBench::open(const QString &path)
+{
+    if (!DatabaseManager::instance().initializeDatabase(path)) {
+        qWarning() << "Failed to open benchmark database" << path;
+        return false;
+    }
+    return loadFixture(f);
+}
+
+bool DbBench::openSeeded()
+{
+    QFETCH_GLOBAL(int, orders);
+    QString path = QDir(seedDir).filePath(QString("dbbench-%1.db").arg(orders));
+    bool seeded = QFileInfo::exists(path);
+    if (!DatabaseManager::instance().initializeDatabase(path)) {
+        qWarning() << "Failed to create benchmark database" << path;
+        return false;
+    }
+    if (!seeded) {
+        qInfo() << "Seeding" << orders << "orders into" << path;
+        if (!seed(orders)) {
+            QFile::remove(path);
+            return false;
+        }
+    }
+    if (!loadFixture(f)) {
+        qWarning() << "Benchmark database" << path << "is missing its seed data";
+        return false;
+    }
+    return true;
+}
+
+bool DbBench::openCopy()
+{
+    if (!openSeeded()) {
+        return false;
+    }
+    // Fold the WAL into the main file so a plain file copy holds every seeded row
+    QSqlQuery checkpoint(DatabaseManager::instance().database());
+    if (!checkpoint.exec("PRAGMA wal_checkpoint(TRUNCATE)")) {
+        qWarning() << "Checkpoint failed:" << checkpoint.lastError().text();
+        return false;
+    }
+    checkpoint.finish();
+
+    QFETCH_GLOBAL(int, orders);
+    QString source = DatabaseManager::instance().database().databaseName();
+    QString previous = copyPath;
+    copyPath = tempDir.filePath(QString("write-%1-%2.db").arg(orders).arg(++copySerial));
+    if (!QFile::copy(source, copyPath) || !open(copyPath)) {
+        return false;
+    }
+    if (!previous.isEmpty()) {
+        for (const QString &suffix : {"", "-wal", "-shm"}) {
+            QFile::remove(previous + suffix);
+        }
+    }
+    return true;
+}
+
+void DbBench::validateLogin()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db] {
+        QString userType;
+        db.validateLogin("bench_student1", "pass123", userType);
+    });
+}
+
+void DbBench::getUserId()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db] { db.getUserId("bench_student500"); });
+}
+
+void DbBench::usernameExists()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db] { db.usernameExists("bench_student500"); });
+}
+
+void DbBench::getUsername()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getUsername(f.studentId); });
+}
+
+void DbBench::getShopId()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getShopId(f.vendorId); });
+}
+
+void DbBench::getShopName()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getShopName(f.shopId); });
+}
+
+void DbBench::getAllShops()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db] { db.getAllShops(); });
+}
+
+void DbBench::getAllAvailableProducts()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db] { db.getAllAvailableProducts(); });
+}
+
+void DbBench::catalog()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db] { db.catalog(); });
+}
+
+void DbBench::searchProducts()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db] { db.searchProducts("bench item 1", 50); });
+}
+
+void DbBench::getProductsByShop()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getProductsByShop(f.shopId); });
+}
+
+void DbBench::getOrdersByShop()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getOrdersByShop(f.shopId); });
+}
+
+void DbBench::getOrdersByShopPage()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getOrdersByShopPage(f.shopId, OrderCursor(), 50); });
+}
+
+void DbBench::getOrdersByShopPageCompleted()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getOrdersByShopPage(f.shopId, OrderCursor(), 10, "completed", true); });
+}
+
+void DbBench::getOrdersByStudent()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getOrdersByStudent(f.studentId); });
+}
+
+void DbBench::getOrdersByStudentPage()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getOrdersByStudentPage(f.studentId, OrderCursor(), 50, true); });
+}
+
+void DbBench::getOrderItems()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getOrderItems(f.orderId); });
+}
+
+void DbBench::getOrderChangesSince()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    qint64 since = db.getOrderChangeSequence() - 10;
+    bench([&db, this, since] { db.getOrderChangesSince(f.shopId, since); });
+}
+
+void DbBench::getShopStats()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getShopStats(f.shopId); });
+}
+
+void DbBench::getTotalRevenue()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getTotalRevenue(f.shopId); });
+}
+
+void DbBench::getTodayRevenue()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getTodayRevenue(f.shopId); });
+}
+
+void DbBench::getTotalOrdersCount()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getTotalOrdersCount(f.shopId); });
+}
+
+void DbBench::getCompletedOrdersCount()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] { db.getCompletedOrdersCount(f.shopId); });
+}
+
+void DbBench::exportOrders()
+{
+    QVERIFY(openSeeded());
+    DatabaseManager &db = DatabaseManager::instance();
+    QString path = tempDir.filePath("export.csv");
+    bench([&db, this, &path] {
+        db.exportOrdersAsync(f.shopId, QDate::currentDate(), ExportFormat::Csv, path).waitForFinished();
+    });
+}
+
+void DbBench::registerUser()
+{
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    int serial = 0;
+    bench([&db, &serial] { db.registerUser(QString("bench_new%1").arg(++serial), "pass123", "student"); });
+}
+
+void DbBench::registerShop()
+{
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    int serial = 0;
+    bench([&db, this, &serial] {
+        db.registerShop(f.vendorId, QString("Bench New Shop %1").arg(++serial), "N1", "");
+    });
+}
+
+void DbBench::addProduct()
+{
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    int serial = 0;
+    bench([&db, this, &serial] { db.addProduct(f.shopId, QString("Bench New Item %1").arg(++serial), 25.0, "Bench"); });
+}
+
+void DbBench::updateProductAvailability()
+{
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    bool available = true;
+    bench([&db, this, &available] {
+        available = !available;
+        db.updateProductAvailability(f.productId, available);
+    });
+}
+
+void DbBench::placeOrder_data()
+{
+    QTest::addColumn<int>("lines");
+    QTest::newRow("1 item") << 1;
+    QTest::newRow("10 items") << 10;
+}
+
+void DbBench::placeOrder()
+{
+    QFETCH(int, lines);
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    QVector<OrderLine> cart(lines, {f.productId, f.shopId, 1, f.productPrice});
+    bench([&db, this, &cart] { db.placeOrder(f.studentId, cart); });
+}
+
+void DbBench::createOrderAndAddOrderItem()
+{
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    bench([&db, this] {
+        int orderId = db.createOrder(f.studentId, f.shopId, f.productPrice);
+        db.addOrderItem(orderId, f.productId, 1, f.productPrice);
+    });
+}
+
+void DbBench::updateOrderStatus()
+{
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    bool preparing = false;
+    bench([&db, this, &preparing] {
+        preparing = !preparing;
+        db.updateOrderStatus(f.orderId, preparing ? "preparing" : "pending");
+    });
+}
+
+void DbBench::saveCartItem()
+{
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    int quantity = 0;
+    bench([&db, this, &quantity] { db.saveCartItem(f.studentId, f.productId, 1 + ++quantity % 5); });
+}
+
+void DbBench::getSavedCart()
+{
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    for (int productId : f.productIds) {
+        QVERIFY(db.saveCartItem(f.studentId, productId, 2));
+    }
+    bench([&db, this] { db.getSavedCart(f.studentId); });
+}
+
+void DbBench::clearSavedCart()
+{
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    // Clearing an empty cart would time nothing, so each iteration refills five lines first
+    bench([&db, this] {
+        for (int productId : f.productIds) {
+            db.saveCartItem(f.studentId, productId, 2);
+        }
+        db.clearSavedCart(f.studentId);
+    });
+}
+
+void DbBench::importProducts_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::newRow("1k rows") << 1000;
+    QTest::newRow("100k rows") << kImportTargetRows;
+}
+
+void DbBench::importProducts()
+{
+    QFETCH(int, rows);
+    QString path = importFile(rows);
+    QVERIFY(!path.isEmpty());
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    ProductImportResult result;
+    QElapsedTimer elapsed;
+    QBENCHMARK_ONCE {
+        elapsed.start();
+        result = db.importProductsAsync(f.shopId, path).result();
+    }
+    qint64 ms = elapsed.elapsed();
+    QCOMPARE(result.imported, rows);
+
+    // The import's throughput target; reported rather than failed, since it depends on the disk
+    if (rows == kImportTargetRows) {
+        qInfo().noquote() << QString("Imported %1 rows in %2 ms (target: under %3 ms)%4")
+                                 .arg(rows).arg(ms).arg(kImportTargetMs)
+                                 .arg(ms < kImportTargetMs ? "" : " - target missed");
+    }
+}
+
+void DbBench::archiveCompletedOrders()
+{
+    QVERIFY(openCopy());
+    DatabaseManager &db = DatabaseManager::instance();
+    int moved = 0;
+    QBENCHMARK_ONCE {
+        moved = db.archiveCompletedOrders(kArchiveDays);
+    }
+    QVERIFY(moved >= 0);
+}
+
+QTEST_GUILESS_MAIN(DbBench)
+
+#include "dbbench.moc"
@@ -0,0 +1,327 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QThread>
+#include <QRandomGenerator>
+#include <QHash>
+#include <QTextStream>
+#include <QAtomicInt>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include "databasemanager.h"
+#include "querytrace.h"
+
+// Replays lunch-rush traffic: K students browse, search, order and check history while V vendors
+// poll their boards and move orders to preparing and completed, all from several threads on one file.
+namespace {
+
+const int kProductsPerShop = 20;
+const int kMaxCartLines = 3;
+const QStringList kSearchTerms = {"biryani", "item", "load", "veg", "rice", "coke"};
+
+struct Options {
+    int students;
+    int vendors;
+    int threads;
+    int durationSeconds;
+    double ordersPerStudentPerMinute;
+    int vendorPollMs;
+};
+
+struct Student {
+    int id;
+    qint64 nextActionNs = 0;
+};
+
+struct Vendor {
+    int shopId;
+    qint64 lastChangeSeq = 0;
+    qint64 nextPollNs = 0;
+};
+
+// Per-thread latency samples and failure counts, merged once the run ends
+struct OperationStats {
+    QVector<qint64> latenciesNs;
+    int failures = 0;
+};
+using Stats = QHash<QString, OperationStats>;
+
+class Recorder
+{
+public:
+    explicit Recorder(Stats &stats) : stats(stats) {}
+
+    template <typename Func>
+    void time(const QString &operation, Func &&call) {
+        QElapsedTimer timer;
+        timer.start();
+        bool ok = call();
+        OperationStats &entry = stats[operation];
+        entry.latenciesNs.append(timer.nsecsElapsed());
+        if (!ok) {
+            ++entry.failures;
+        }
+    }
+
+private:
+    Stats &stats;
+};
+
+bool seed(const Options &options, QVector<Student> &students, QVector<Vendor> &vendors) {
+    DatabaseManager &db = DatabaseManager::instance();
+
+    for (int i = 1; i <= options.students; ++i) {
+        QString name = QString("load_student%1").arg(i);
+        if (!db.usernameExists(name)) {
+            db.registerUser(name, "pass123", "student");
+        }
+        int id = db.getUserId(name);
+        if (id == -1) {
+            return false;
+        }
+        students.append({id});
+    }
+
+    for (int i = 1; i <= options.vendors; ++i) {
+        QString name = QString("load_vendor%1").arg(i);
+        if (!db.usernameExists(name)) {
+            db.registerUser(name, "pass123", "vendor");
+        }
+        int vendorId = db.getUserId(name);
+        if (vendorId == -1) {
+            return false;
+        }
+        int shopId = db.getShopId(vendorId);
+        if (shopId == -1) {
+            db.registerShop(vendorId, QString("Load Shop %1").arg(i), QString("L%1").arg(i), "");
+            shopId = db.getShopId(vendorId);
+            for (int p = 1; p <= kProductsPerShop; ++p) {
+                db.addProduct(shopId, QString("Load Item %1-%2").arg(i).arg(p), 20.0 + p * 5, "Load");
+            }
+        }
+        if (shopId == -1) {
+            return false;
+        }
+        vendors.append({shopId, db.getOrderChangeSequence()});
+    }
+    return true;
+}
+
+qint64 exponentialDelayNs(QRandomGenerator &random, double meanSeconds) {
+    return qint64(-std::log(1.0 - random.generateDouble()) * meanSeconds * 1e9);
+}
+
+void studentTurn(Student &student, Recorder &recorder, QRandomGenerator &random) {
+    DatabaseManager &db = DatabaseManager::instance();
+
+    CatalogSnapshot catalog;
+    recorder.time("browse.catalog", [&] {
+        catalog = db.catalog();
+        return !catalog.products.isEmpty();
+    });
+    recorder.time("browse.search", [&] {
+        db.searchProducts(kSearchTerms[random.bounded(int(kSearchTerms.size()))]);
+        return true;
+    });
+    if (catalog.products.isEmpty()) {
+        return;
+    }
+
+    // Carts are single-shop, like the student window enforces
+    const Product &first = catalog.products[random.bounded(int(catalog.products.size()))];
+    QVector<OrderLine> cart;
+    int lines = 1 + random.bounded(kMaxCartLines);
+    for (const Product &product : catalog.products) {
+        if (product.shopId == first.shopId && cart.size() < lines && random.bounded(4) == 0) {
+            cart.append({product.id, product.shopId, 1 + random.bounded(3), product.price});
+        }
+    }
+    if (cart.isEmpty()) {
+        cart.append({first.id, first.shopId, 1, first.price});
+    }
+
+    recorder.time("student.placeOrder", [&] { return db.placeOrder(student.id, cart) != -1; });
+    recorder.time("student.history", [&] {
+        db.getOrdersByStudentPage(student.id, OrderCursor(), 50, true);
+        return true;
+    });
+}
+
+void vendorTurn(Vendor &vendor, Recorder &recorder) {
+    DatabaseManager &db = DatabaseManager::instance();
+
+    QVector<OrderSummary> changes;
+    recorder.time("vendor.poll", [&] {
+        changes = db.getOrderChangesSince(vendor.shopId, vendor.lastChangeSeq);
+        return true;
+    });
+
+    for (const OrderSummary &order : changes) {
+        vendor.lastChangeSeq = qMax(vendor.lastChangeSeq, order.changeSeq);
+        if (order.status == "pending") {
+            recorder.time("vendor.accept", [&] { return db.updateOrderStatus(order.id, "preparing"); });
+        } else if (order.status == "preparing") {
+            recorder.time("vendor.complete", [&] { return db.updateOrderStatus(order.id, "completed"); });
+        }
+    }
+
+    recorder.time("vendor.stats", [&] {
+        db.getShopStats(vendor.shopId);
+        return true;
+    });
+}
+
+// One worker owns a fixed slice of actors and runs whichever is due next
+void runWorker(const Options &options, QVector<Student> students, QVector<Vendor> vendors,
+               Stats &stats, qint64 durationNs) {
+    Recorder recorder(stats);
+    QRandomGenerator random(QRandomGenerator::global()->generate());
+    double meanStudentSeconds = 60.0 / options.ordersPerStudentPerMinute;
+
+    QElapsedTimer clock;
+    clock.start();
+    for (Student &student : students) {
+        student.nextActionNs = exponentialDelayNs(random, meanStudentSeconds);
+    }
+
+    while (clock.nsecsElapsed() < durationNs) {
+        qint64 now = clock.nsecsElapsed();
+        qint64 nextDue = now + 5 * 1000 * 1000;
+
+        for (Student &student : students) {
+            if (student.nextActionNs <= now) {
+                studentTurn(student, recorder, random);
+                student.nextActionNs = clock.nsecsElapsed() + exponentialDelayNs(random, meanStudentSeconds);
+            }
+            nextDue = qMin(nextDue, student.nextActionNs);
+        }
+        for (Vendor &vendor : vendors) {
+            if (vendor.nextPollNs <= now) {
+                vendorTurn(vendor, recorder);
+                vendor.nextPollNs = clock.nsecsElapsed() + qint64(options.vendorPollMs) * 1000 * 1000;
+            }
+            nextDue = qMin(nextDue, vendor.nextPollNs);
+        }
+
+        qint64 sleepNs = nextDue - clock.nsecsElapsed();
+        if (sleepNs > 0) {
+            QThread::usleep(sleepNs / 1000);
+        }
+    }
+}
+
+double percentileMs(const QVector<qint64> &sorted, double fraction) {
+    int index = qMin(int(sorted.size()) - 1, int(sorted.size() * fraction));
+    return sorted[index] / 1e6;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QueryTrace::configureFromEnvironment();
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Lunch-rush load generator for the CEG SQUARE database");
+    parser.addHelpOption();
+    parser.addOption({"db", "SQLite file to load (default: a temporary file).", "path"});
+    parser.addOption({"students", "Simulated students.", "count", "300"});
+    parser.addOption({"vendors", "Simulated vendors, one shop each.", "count", "5"});
+    parser.addOption({"threads", "Worker threads sharing the actors.", "count", "8"});
+    parser.addOption({"duration", "Run time in seconds.", "seconds", "30"});
+    parser.addOption({"order-rate", "Orders per student per minute.", "rate", "2"});
+    parser.addOption({"vendor-poll", "Vendor board poll interval in ms.", "ms", "500"});
+    parser.addOption({"busy-timeout", "SQLite busy timeout in ms.", "ms", "5000"});
+    parser.process(app);
+
+    Options options;
+    options.students = qMax(1, parser.value("students").toInt());
+    options.vendors = qMax(1, parser.value("vendors").toInt());
+    options.threads = qMax(1, parser.value("threads").toInt());
+    options.durationSeconds = qMax(1, parser.value("duration").toInt());
+    options.ordersPerStudentPerMinute = qMax(0.01, parser.value("order-rate").toDouble());
+    options.vendorPollMs = qMax(10, parser.value("vendor-poll").toInt());
+
+    QTemporaryDir tempDir;
+    QString path = parser.isSet("db") ? parser.value("db") : QDir(tempDir.path()).filePath("loadgen.db");
+
+    DatabaseManager &db = DatabaseManager::instance();
+    db.setBusyTimeout(parser.value("busy-timeout").toInt());
+    if (!db.initializeDatabase(path)) {
+        err << "Failed to open " << path << "\n";
+        return 1;
+    }
+
+    QVector<Student> students;
+    QVector<Vendor> vendors;
+    if (!seed(options, students, vendors)) {
+        err << "Failed to seed load users\n";
+        return 1;
+    }
+
+    err << QString("Running %1 students, %2 vendors on %3 threads for %4 s against %5\n")
+               .arg(options.students).arg(options.vendors).arg(options.threads)
+               .arg(options.durationSeconds).arg(path);
+
+    // Deal actors round-robin so every thread mixes students and vendors
+    QVector<QVector<Student>> studentSlices(options.threads);
+    QVector<QVector<Vendor>> vendorSlices(options.threads);
+    for (int i = 0; i < students.size(); ++i) {
+        studentSlices[i % options.threads].append(students[i]);
+    }
+    for (int i = 0; i < vendors.size(); ++i) {
+        vendorSlices[i % options.threads].append(vendors[i]);
+    }
+
+    qint64 busyBefore = db.busyErrors();
+    qint64 durationNs = qint64(options.durationSeconds) * 1000 * 1000 * 1000;
+    QVector<Stats> threadStats(options.threads);
+    std::vector<std::unique_ptr<QThread>> workers;
+    QElapsedTimer wall;
+    wall.start();
+    for (int t = 0; t < options.threads; ++t) {
+        workers.emplace_back(QThread::create(runWorker, std::cref(options), studentSlices[t], vendorSlices[t],
+                                             std::ref(threadStats[t]), durationNs));
+        workers.back()->start();
+    }
+    for (auto &worker : workers) {
+        worker->wait();
+    }
+    double elapsedSeconds = wall.nsecsElapsed() / 1e9;
+
+    Stats merged;
+    for (const Stats &stats : threadStats) {
+        for (auto it = stats.cbegin(); it != stats.cend(); ++it) {
+            OperationStats &entry = merged[it.key()];
+            entry.latenciesNs += it.value().latenciesNs;
+            entry.failures += it.value().failures;
+        }
+    }
+
+    QStringList operations = merged.keys();
+    operations.sort();
+    out << QString("%1 %2 %3 %4 %5 %6 %7\n")
+               .arg("operation", -20).arg("count", 8).arg("ops/s", 9).arg("p50 ms", 9)
+               .arg("p99 ms", 9).arg("max ms", 9).arg("failed", 7);
+    for (const QString &operation : operations) {
+        OperationStats &entry = merged[operation];
+        std::sort(entry.latenciesNs.begin(), entry.latenciesNs.end());
+        out << QString("%1 %2 %3 %4 %5 %6 %7\n")
+                   .arg(operation, -20)
+                   .arg(entry.latenciesNs.size(), 8)
+                   .arg(entry.latenciesNs.size() / elapsedSeconds, 9, 'f', 1)
+                   .arg(percentileMs(entry.latenciesNs, 0.50), 9, 'f', 2)
+                   .arg(percentileMs(entry.latenciesNs, 0.99), 9, 'f', 2)
+                   .arg(entry.latenciesNs.last() / 1e6, 9, 'f', 2)
+                   .arg(entry.failures, 7);
+    }
+    out << QString("SQLITE_BUSY/LOCKED errors: %1\n").arg(db.busyErrors() - busyBefore);
+    QueryTrace::dump();
+    return 0;
+}
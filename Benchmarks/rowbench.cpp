@@ -0,0 +1,197 @@
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTextStream>
+#include <QHash>
+#include <atomic>
+#include "databasemanager.h"
+
+// Counts heap allocations made by the measured code. Qt containers allocate through
+// malloc rather than operator new, so on glibc the C allocator is interposed directly.
+namespace {
+
+std::atomic<bool> counting{false};
+std::atomic<qint64> allocations{0};
+
+void countAllocation() {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+}
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+namespace {
+
+const int kRows = 10000;
+
+struct Measurement {
+    qint64 allocations;
+    qint64 nanoseconds;
+    int rows;
+};
+
+template <typename Func>
+Measurement measure(Func &&read) {
+    allocations = 0;
+    QElapsedTimer timer;
+    timer.start();
+    counting = true;
+    int rows = read();
+    counting = false;
+    return {allocations.load(), timer.nsecsElapsed(), rows};
+}
+
+// Prepared once and forward-only like the manager's cached statements, so the two paths
+// differ only in how each row is stored
+QSqlQuery &legacyQuery(const QString &sql) {
+    static QHash<QString, QSqlQuery> queries;
+    auto it = queries.find(sql);
+    if (it == queries.end()) {
+        it = queries.insert(sql, QSqlQuery(DatabaseManager::instance().database()));
+        it->setForwardOnly(true);
+        it->prepare(sql);
+    }
+    return *it;
+}
+
+// The pre-typed result shape: one heap vector of boxed cells per row
+int readLegacyProducts() {
+    QVector<QVector<QVariant>> products;
+    QSqlQuery &query = legacyQuery("SELECT p.id, p.name, s.shop_name, p.price, p.category, p.available, s.id "
+                                   "FROM products p "
+                                   "JOIN shops s ON p.shop_id = s.id "
+                                   "WHERE p.available = 1");
+    query.exec();
+    while (query.next()) {
+        QVector<QVariant> product;
+        for (int i = 0; i < 7; ++i) {
+            product.append(query.value(i));
+        }
+        products.append(product);
+    }
+    query.finish();
+    return products.size();
+}
+
+int readLegacyOrders(int studentId) {
+    QVector<QVector<QVariant>> orders;
+    QSqlQuery &query = legacyQuery("SELECT o.id, s.shop_name, o.total_amount, o.status, o.order_date "
+                                   "FROM orders o "
+                                   "JOIN shops s ON o.shop_id = s.id "
+                                   "WHERE o.student_id = ? "
+                                   "ORDER BY o.order_date DESC");
+    query.bindValue(0, studentId);
+    query.exec();
+    while (query.next()) {
+        QVector<QVariant> order;
+        for (int i = 0; i < 5; ++i) {
+            order.append(query.value(i));
+        }
+        orders.append(order);
+    }
+    query.finish();
+    return orders.size();
+}
+
+bool seed(int shopId, int studentId) {
+    QSqlDatabase db = DatabaseManager::instance().database();
+    QSqlQuery query(db);
+    db.transaction();
+
+    query.prepare("INSERT INTO products (shop_id, name, price, category) VALUES (?, ?, ?, ?)");
+    for (int i = 0; i < kRows; ++i) {
+        query.bindValue(0, shopId);
+        query.bindValue(1, QString("Bench Item %1").arg(i));
+        query.bindValue(2, 10.0 + i % 90);
+        query.bindValue(3, "Bench");
+        if (!query.exec()) {
+            return false;
+        }
+    }
+
+    query.prepare("INSERT INTO orders (student_id, shop_id, total_amount, status) VALUES (?, ?, ?, 'completed')");
+    for (int i = 0; i < kRows; ++i) {
+        query.bindValue(0, studentId);
+        query.bindValue(1, shopId);
+        query.bindValue(2, 50.0 + i % 200);
+        if (!query.exec()) {
+            return false;
+        }
+    }
+    return db.commit();
+}
+
+void report(QTextStream &out, const QString &name, const Measurement &m) {
+    double perTenK = m.rows > 0 ? double(m.allocations) * kRows / m.rows : 0.0;
+    out << QString("%1 rows=%2 allocations=%3 allocations_per_10k_rows=%4 ms=%5\n")
+               .arg(name, -28)
+               .arg(m.rows)
+               .arg(m.allocations)
+               .arg(perTenK, 0, 'f', 0)
+               .arg(m.nanoseconds / 1e6, 0, 'f', 2);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QTemporaryDir dir;
+    if (!dir.isValid() || !DatabaseManager::instance().initializeDatabase(dir.filePath("rowbench.db"))) {
+        out << "Failed to create benchmark database\n";
+        return 1;
+    }
+
+    DatabaseManager &db = DatabaseManager::instance();
+    int studentId = db.getUserId("student1");
+    int shopId = db.getShopId(db.getUserId("vendor1"));
+    if (studentId == -1 || shopId == -1 || !seed(shopId, studentId)) {
+        out << "Failed to seed benchmark database\n";
+        return 1;
+    }
+
+#ifndef __GLIBC__
+    out << "Allocation counts need glibc; only timings are meaningful on this platform\n";
+#endif
+
+    // Warm both paths so statement preparation and page cache are excluded
+    readLegacyProducts();
+    db.getAllAvailableProducts();
+    readLegacyOrders(studentId);
+    db.getOrdersByStudent(studentId);
+
+    report(out, "products QVector<QVariant>", measure([] { return readLegacyProducts(); }));
+    report(out, "products Product", measure([&db] { return int(db.getAllAvailableProducts().size()); }));
+    report(out, "orders QVector<QVariant>", measure([studentId] { return readLegacyOrders(studentId); }));
+    report(out, "orders OrderSummary", measure([&db, studentId] { return int(db.getOrdersByStudent(studentId).size()); }));
+
+    return 0;
+}
@@ -0,0 +1,34 @@
+QT += core sql concurrent network
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../Database
+
+SOURCES += \
+    rowbench.cpp \
+    ../Database/databasemanager.cpp \
+    ../Database/statementcache.cpp \
+    ../Database/querytrace.cpp \
+    ../Database/slowquerylog.cpp \
+    ../Database/csvreader.cpp \
+    ../Database/orderprotocol.cpp \
+    ../Database/orderserviceclient.cpp
+
+HEADERS += \
+    ../Database/databasemanager.h \
+    ../Database/statementcache.h \
+    ../Database/querytrace.h \
+    ../Database/slowquerylog.h \
+    ../Database/csvreader.h \
+    ../Database/orderprotocol.h \
+    ../Database/orderserviceclient.h
+
+# Release configuration
+CONFIG += release
+
+# Output directories
+DESTDIR = $$PWD/bin
+OBJECTS_DIR = $$PWD/build/obj
+MOC_DIR = $$PWD/build/moc
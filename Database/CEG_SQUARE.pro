@@ -1,18 +1,42 @@
-QT += core gui widgets sql
+QT += core gui widgets sql concurrent network
 
 CONFIG += c++17
 
 SOURCES += \
     main.cpp \
+    startuptrace.cpp \
     databasemanager.cpp \
+    statementcache.cpp \
+    querytrace.cpp \
+    slowquerylog.cpp \
+    csvreader.cpp \
+    orderprotocol.cpp \
+    orderserviceclient.cpp \
     logindialog.cpp \
     studentwindow.cpp \
+    menumodel.cpp \
+    menudelegate.cpp \
+    cart.cpp \
+    orderboardmodel.cpp \
+    orderboarddelegate.cpp \
     vendorwindow.cpp
 
 HEADERS += \
+    startuptrace.h \
     databasemanager.h \
+    statementcache.h \
+    querytrace.h \
+    slowquerylog.h \
+    csvreader.h \
+    orderprotocol.h \
+    orderserviceclient.h \
     logindialog.h \
     studentwindow.h \
+    menumodel.h \
+    menudelegate.h \
+    cart.h \
+    orderboardmodel.h \
+    orderboarddelegate.h \
     vendorwindow.h
 
 FORMS += \
@@ -0,0 +1,69 @@
+#include "csvreader.h"
+
+CsvReader::CsvReader(QIODevice *device) :
+    stream(device)
+{
+}
+
+bool CsvReader::readRow(QStringList &fields) {
+    fields.clear();
+    QString line;
+
+    // Skip blank lines between rows
+    do {
+        if (!stream.readLineInto(&line)) {
+            return false;
+        }
+        currentRowLine = nextLine++;
+    } while (line.trimmed().isEmpty());
+
+    // Most rows have no quoting at all
+    if (!line.contains('"')) {
+        fields = line.split(',');
+        return true;
+    }
+
+    QString field;
+    bool quoted = false;
+    int i = 0;
+    while (true) {
+        if (i == line.size()) {
+            if (!quoted) {
+                break;
+            }
+            // Quoted field continues on the next line
+            QString continuation;
+            if (!stream.readLineInto(&continuation)) {
+                break;
+            }
+            ++nextLine;
+            field += '\n';
+            line = continuation;
+            i = 0;
+            continue;
+        }
+
+        QChar c = line.at(i++);
+        if (quoted) {
+            if (c == '"') {
+                if (i < line.size() && line.at(i) == '"') {
+                    field += '"';
+                    ++i;
+                } else {
+                    quoted = false;
+                }
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.append(field);
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.append(field);
+    return true;
+}
@@ -0,0 +1,25 @@
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+#include <QIODevice>
+#include <QStringList>
+#include <QTextStream>
+
+// Streams CSV rows one at a time. Quoted fields may contain commas, doubled quotes and line breaks.
+class CsvReader
+{
+public:
+    explicit CsvReader(QIODevice *device);
+
+    // Returns false at end of input; blank lines are skipped
+    bool readRow(QStringList &fields);
+    // Line on which the last returned row started (1-based)
+    int rowLine() const { return currentRowLine; }
+
+private:
+    QTextStream stream;
+    int nextLine = 1;
+    int currentRowLine = 0;
+};
+
+#endif
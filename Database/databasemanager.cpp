@@ -1,16 +1,432 @@
 #include "databasemanager.h"
+#include "csvreader.h"
+#include "querytrace.h"
+#include "orderserviceclient.h"
 #include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QRegularExpression>
+#include <QThread>
+#include <QTimer>
+#include <QLocalSocket>
+#include <utility>
 
-bool DatabaseManager::initializeDatabase() {
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName("ceg_square.db");
+using OrderProtocol::Op;
+
+namespace {
+
+// 4 binds per row stays well under SQLITE_MAX_VARIABLE_NUMBER on every SQLite build
+const int kMaxOrderItemsPerInsert = 200;
+
+const int kResubscribeMs = 2000;
+
+const int kImportRowsPerInsert = 200;
+const int kImportRowsPerTransaction = 10000;
+const int kMaxReportedImportErrors = 100;
+
+const int kExportBufferBytes = 64 * 1024;
+const int kExportProgressRows = 1000;
+
+QString csvField(const QString &value) {
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n')) {
+        return value;
+    }
+    QString escaped = value;
+    escaped.replace("\"", "\"\"");
+    return QString("\"%1\"").arg(escaped);
+}
+
+// Hot and archived orders as one relation; SQLite merges the two index-ordered scans
+const char *const kAllOrders =
+    "(SELECT id, student_id, shop_id, total_amount, status, order_date, items_summary FROM orders "
+    "UNION ALL "
+    "SELECT id, student_id, shop_id, total_amount, status, order_date, items_summary FROM orders_archive)";
+
+struct Migration {
+    int version;
+    const char *description;
+    QStringList statements;
+};
+
+// Schema steps applied once each, in order, and recorded in PRAGMA user_version.
+// Never edit a released step; append a new one instead.
+const QVector<Migration> &migrations() {
+    static const QVector<Migration> steps = {
+        {1, "Covering indexes for order and product lookups", {
+             "CREATE INDEX IF NOT EXISTS idx_orders_shop_status_date "
+             "ON orders(shop_id, status, order_date, total_amount)",
+             "CREATE INDEX IF NOT EXISTS idx_orders_shop_date ON orders(shop_id, order_date)",
+             "CREATE INDEX IF NOT EXISTS idx_orders_student_date ON orders(student_id, order_date)",
+             "CREATE INDEX IF NOT EXISTS idx_order_items_order "
+             "ON order_items(order_id, product_id, quantity, price)",
+             "CREATE INDEX IF NOT EXISTS idx_products_shop_available ON products(shop_id, available)",
+             "CREATE INDEX IF NOT EXISTS idx_shops_vendor ON shops(vendor_id)"
+         }},
+        {2, "Trigger-maintained per-shop revenue and order counts", {
+             "CREATE TABLE IF NOT EXISTS shop_stats ("
+             "shop_id INTEGER PRIMARY KEY, "
+             "total_orders INTEGER NOT NULL DEFAULT 0, "
+             "completed_orders INTEGER NOT NULL DEFAULT 0, "
+             "total_revenue REAL NOT NULL DEFAULT 0)",
+             "CREATE TABLE IF NOT EXISTS shop_daily_stats ("
+             "shop_id INTEGER NOT NULL, "
+             "day TEXT NOT NULL, "
+             "completed_orders INTEGER NOT NULL DEFAULT 0, "
+             "revenue REAL NOT NULL DEFAULT 0, "
+             "PRIMARY KEY(shop_id, day)) WITHOUT ROWID",
+             "INSERT OR REPLACE INTO shop_stats (shop_id, total_orders, completed_orders, total_revenue) "
+             "SELECT shop_id, COUNT(*), SUM(status = 'completed'), "
+             "TOTAL(CASE WHEN status = 'completed' THEN total_amount END) "
+             "FROM orders GROUP BY shop_id",
+             "INSERT OR REPLACE INTO shop_daily_stats (shop_id, day, completed_orders, revenue) "
+             "SELECT shop_id, DATE(order_date), COUNT(*), TOTAL(total_amount) "
+             "FROM orders WHERE status = 'completed' GROUP BY shop_id, DATE(order_date)",
+             // Revenue is attributed to the order's day, matching the old DATE(order_date) = DATE('now') query
+             "CREATE TRIGGER IF NOT EXISTS trg_orders_stats_insert AFTER INSERT ON orders BEGIN "
+             "INSERT INTO shop_stats (shop_id, total_orders, completed_orders, total_revenue) "
+             "VALUES (NEW.shop_id, 1, NEW.status = 'completed', "
+             "CASE WHEN NEW.status = 'completed' THEN NEW.total_amount ELSE 0 END) "
+             "ON CONFLICT(shop_id) DO UPDATE SET "
+             "total_orders = total_orders + 1, "
+             "completed_orders = completed_orders + excluded.completed_orders, "
+             "total_revenue = total_revenue + excluded.total_revenue; "
+             "INSERT INTO shop_daily_stats (shop_id, day, completed_orders, revenue) "
+             "SELECT NEW.shop_id, DATE(NEW.order_date), 1, NEW.total_amount WHERE NEW.status = 'completed' "
+             "ON CONFLICT(shop_id, day) DO UPDATE SET "
+             "completed_orders = completed_orders + 1, "
+             "revenue = revenue + excluded.revenue; "
+             "END",
+             "CREATE TRIGGER IF NOT EXISTS trg_orders_stats_status AFTER UPDATE OF status ON orders "
+             "WHEN (OLD.status = 'completed') <> (NEW.status = 'completed') BEGIN "
+             "UPDATE shop_stats SET "
+             "completed_orders = completed_orders + CASE WHEN NEW.status = 'completed' THEN 1 ELSE -1 END, "
+             "total_revenue = total_revenue + "
+             "CASE WHEN NEW.status = 'completed' THEN NEW.total_amount ELSE -OLD.total_amount END "
+             "WHERE shop_id = NEW.shop_id; "
+             "INSERT INTO shop_daily_stats (shop_id, day, completed_orders, revenue) "
+             "VALUES (NEW.shop_id, DATE(NEW.order_date), "
+             "CASE WHEN NEW.status = 'completed' THEN 1 ELSE -1 END, "
+             "CASE WHEN NEW.status = 'completed' THEN NEW.total_amount ELSE -OLD.total_amount END) "
+             "ON CONFLICT(shop_id, day) DO UPDATE SET "
+             "completed_orders = completed_orders + excluded.completed_orders, "
+             "revenue = revenue + excluded.revenue; "
+             "END"
+         }},
+        {3, "Denormalized order item summary", {
+             "ALTER TABLE orders ADD COLUMN items_summary TEXT",
+             "UPDATE orders SET items_summary = "
+             "(SELECT GROUP_CONCAT(p.name || ' x ' || oi.quantity) "
+             "FROM order_items oi "
+             "JOIN products p ON oi.product_id = p.id "
+             "WHERE oi.order_id = orders.id)",
+             // Appends in insertion order, producing the same text GROUP_CONCAT did
+             "CREATE TRIGGER IF NOT EXISTS trg_order_items_summary AFTER INSERT ON order_items BEGIN "
+             "UPDATE orders SET items_summary = COALESCE(items_summary || ',', '') || "
+             "(SELECT name FROM products WHERE id = NEW.product_id) || ' x ' || NEW.quantity "
+             "WHERE id = NEW.order_id AND EXISTS (SELECT 1 FROM products WHERE id = NEW.product_id); "
+             "END"
+         }},
+        {4, "Order change sequence for incremental refresh", {
+             "CREATE TABLE IF NOT EXISTS change_sequence ("
+             "name TEXT PRIMARY KEY, "
+             "value INTEGER NOT NULL) WITHOUT ROWID",
+             "ALTER TABLE orders ADD COLUMN change_seq INTEGER NOT NULL DEFAULT 0",
+             "ALTER TABLE orders ADD COLUMN updated_at DATETIME",
+             "UPDATE orders SET change_seq = id, updated_at = order_date",
+             "INSERT OR REPLACE INTO change_sequence (name, value) "
+             "SELECT 'orders', COALESCE(MAX(id), 0) FROM orders",
+             "CREATE INDEX IF NOT EXISTS idx_orders_shop_change ON orders(shop_id, change_seq)",
+             // SQLite has a single writer, so sequence values commit in order and a poller never skips one
+             "CREATE TRIGGER IF NOT EXISTS trg_orders_change_insert AFTER INSERT ON orders BEGIN "
+             "UPDATE change_sequence SET value = value + 1 WHERE name = 'orders'; "
+             "UPDATE orders SET change_seq = (SELECT value FROM change_sequence WHERE name = 'orders'), "
+             "updated_at = CURRENT_TIMESTAMP WHERE id = NEW.id; "
+             "END",
+             "CREATE TRIGGER IF NOT EXISTS trg_orders_change_update AFTER UPDATE OF status, items_summary ON orders "
+             "WHEN OLD.status IS NOT NEW.status OR OLD.items_summary IS NOT NEW.items_summary BEGIN "
+             "UPDATE change_sequence SET value = value + 1 WHERE name = 'orders'; "
+             "UPDATE orders SET change_seq = (SELECT value FROM change_sequence WHERE name = 'orders'), "
+             "updated_at = CURRENT_TIMESTAMP WHERE id = NEW.id; "
+             "END"
+         }},
+        {5, "Full-text product search", {
+             "CREATE VIRTUAL TABLE IF NOT EXISTS products_fts USING fts5("
+             "name, category, shop_name, "
+             "tokenize = 'unicode61 remove_diacritics 2', "
+             "prefix = '1 2 3')",
+             "INSERT INTO products_fts (rowid, name, category, shop_name) "
+             "SELECT p.id, p.name, p.category, s.shop_name "
+             "FROM products p JOIN shops s ON p.shop_id = s.id "
+             "WHERE p.available = 1",
+             // Only available products are indexed, so a search never ranks rows it would drop
+             "CREATE TRIGGER IF NOT EXISTS trg_products_fts_insert AFTER INSERT ON products "
+             "WHEN NEW.available = 1 BEGIN "
+             "INSERT INTO products_fts (rowid, name, category, shop_name) "
+             "SELECT NEW.id, NEW.name, NEW.category, shop_name FROM shops WHERE id = NEW.shop_id; "
+             "END",
+             "CREATE TRIGGER IF NOT EXISTS trg_products_fts_update "
+             "AFTER UPDATE OF name, category, shop_id, available ON products BEGIN "
+             "DELETE FROM products_fts WHERE rowid = OLD.id; "
+             "INSERT INTO products_fts (rowid, name, category, shop_name) "
+             "SELECT NEW.id, NEW.name, NEW.category, shop_name FROM shops "
+             "WHERE id = NEW.shop_id AND NEW.available = 1; "
+             "END",
+             "CREATE TRIGGER IF NOT EXISTS trg_products_fts_delete AFTER DELETE ON products BEGIN "
+             "DELETE FROM products_fts WHERE rowid = OLD.id; "
+             "END",
+             "CREATE TRIGGER IF NOT EXISTS trg_shops_fts_rename AFTER UPDATE OF shop_name ON shops BEGIN "
+             "UPDATE products_fts SET shop_name = NEW.shop_name "
+             "WHERE rowid IN (SELECT id FROM products WHERE shop_id = NEW.id); "
+             "END"
+         }},
+        {6, "Archive tables for old completed orders", {
+             // Same columns as the hot tables; ids are kept so cursors and item links stay valid
+             "CREATE TABLE IF NOT EXISTS orders_archive ("
+             "id INTEGER PRIMARY KEY, "
+             "student_id INTEGER, "
+             "shop_id INTEGER, "
+             "total_amount REAL NOT NULL, "
+             "status TEXT, "
+             "order_date DATETIME, "
+             "items_summary TEXT, "
+             "change_seq INTEGER NOT NULL DEFAULT 0, "
+             "updated_at DATETIME)",
+             "CREATE TABLE IF NOT EXISTS order_items_archive ("
+             "id INTEGER PRIMARY KEY, "
+             "order_id INTEGER, "
+             "product_id INTEGER, "
+             "quantity INTEGER, "
+             "price REAL)",
+             "CREATE INDEX IF NOT EXISTS idx_orders_archive_shop_status_date "
+             "ON orders_archive(shop_id, status, order_date, id)",
+             "CREATE INDEX IF NOT EXISTS idx_orders_archive_shop_date ON orders_archive(shop_id, order_date, id)",
+             "CREATE INDEX IF NOT EXISTS idx_orders_archive_student_date ON orders_archive(student_id, order_date, id)",
+             "CREATE INDEX IF NOT EXISTS idx_order_items_archive_order ON order_items_archive(order_id)",
+             "CREATE INDEX IF NOT EXISTS idx_orders_status_date ON orders(status, order_date)"
+         }},
+        {7, "Saved student carts", {
+             // The rowid keeps first-added order; an upsert changes the quantity in place
+             "CREATE TABLE IF NOT EXISTS saved_carts ("
+             "id INTEGER PRIMARY KEY, "
+             "student_id INTEGER NOT NULL, "
+             "product_id INTEGER NOT NULL, "
+             "quantity INTEGER NOT NULL, "
+             "UNIQUE(student_id, product_id))"
+         }},
+    };
+    return steps;
+}
+
+}
+
+// One named connection per thread; QThreadStorage deletes it on the owning thread at exit
+struct DatabaseManager::ThreadConnection {
+    QString name;
+    int generation;
+    StatementCache statements;
+
+    ThreadConnection(const QString &name, int generation, StatementCache::Counters *counters, SlowQueryLog *slowLog) :
+        name(name), generation(generation), statements(name, counters, slowLog) {}
+
+    ~ThreadConnection() {
+        statements.clear();
+        {
+            QSqlDatabase db = QSqlDatabase::database(name, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(name);
+    }
+};
+
+DatabaseManager::DatabaseManager() {
+    // Worker threads never expire, so their connections and statement caches stay warm
+    workerPool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 4));
+    workerPool.setExpiryTimeout(-1);
+
+    // Off unless asked for, so statements are neither timed nor EXPLAINed on a normal start
+    bool ok = false;
+    int slowMs = qEnvironmentVariableIntValue("CEG_SLOW_QUERY_MS", &ok);
+    slowQueries.setThresholdMs(ok ? slowMs : -1);
+}
+
+DatabaseManager::~DatabaseManager() {
+    delete orderService;
+}
+
+void DatabaseManager::setBusyTimeout(int milliseconds) {
+    busyTimeout = milliseconds;
+}
+
+void DatabaseManager::setSlowQueryThreshold(int milliseconds) {
+    slowQueries.setThresholdMs(milliseconds);
+}
+
+int DatabaseManager::slowQueryThreshold() const {
+    return slowQueries.thresholdMs();
+}
+
+void DatabaseManager::setSlowQueryLogPath(const QString &path) {
+    slowQueries.setLogPath(path);
+}
+
+DatabaseManager::ThreadConnection &DatabaseManager::threadConnection() {
+    int generation = databaseGeneration.loadRelaxed();
+    if (!connections.hasLocalData() || connections.localData()->generation != generation) {
+        // setLocalData deletes a connection left open on the previous database file
+        QString name = QString("ceg_square_%1").arg(connectionSerial.fetchAndAddRelaxed(1));
+        connections.setLocalData(new ThreadConnection(name, generation, &statementCounters, &slowQueries));
+        openConnection(name);
+    }
+    return *connections.localData();
+}
+
+QSqlDatabase DatabaseManager::database() {
+    return QSqlDatabase::database(threadConnection().name, false);
+}
+
+bool DatabaseManager::openConnection(const QString &name) {
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(databasePath);
+    db.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(busyTimeout));
 
     if (!db.open()) {
-        qDebug() << "Error: connection with database failed:" << db.lastError().text();
+        qDebug() << "Error: connection" << name << "failed:" << db.lastError().text();
         return false;
     }
 
-    QSqlQuery query;
+    // WAL lets readers on other threads run alongside the single writer
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA journal_mode = WAL") || !query.exec("PRAGMA synchronous = NORMAL")) {
+        qDebug() << "Connection" << name << "pragma error:" << query.lastError().text();
+    }
+    return true;
+}
+
+bool DatabaseManager::beginImmediate(QSqlDatabase &db) {
+    // Take the write lock up front so the busy timeout applies instead of a mid-transaction upgrade failure
+    QSqlQuery query(db);
+    if (!query.exec("BEGIN IMMEDIATE")) {
+        if (isBusyError(query.lastError())) {
+            statementCounters.busy.fetch_add(1, std::memory_order_relaxed);
+        }
+        qDebug() << "Begin transaction error:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::initializeDatabase(const QString &path) {
+    QueryTimer timer("initializeDatabase");
+    // Must run on the GUI thread before any other thread touches the database
+    if (!databasePath.isEmpty() && databasePath != path) {
+        databaseGeneration.ref();
+        invalidateCatalog();
+    }
+    databasePath = path;
+    if (slowQueries.logPath().isEmpty()) {
+        slowQueries.setLogPath(QFileInfo(path).absoluteDir().filePath("slow_queries.log"));
+    }
+
+    QSqlDatabase db = database();
+    if (!db.isOpen()) {
+        return false;
+    }
+
+    // A database at the latest schema version already has its tables, seed rows and indexes
+    int version = schemaVersion();
+    if (version >= migrations().last().version) {
+        return true;
+    }
+
+    // Base tables predate user_version, so only an unversioned database can be missing them
+    if (version == 0 && !createBaseSchema()) {
+        return false;
+    }
+    return runMigrations(version);
+}
+
+bool DatabaseManager::connectToOrderService(const QString &serverName) {
+    QueryTimer timer("connectToOrderService");
+    OrderServiceClient *client = new OrderServiceClient(serverName);
+    if (!client->connectToService()) {
+        delete client;
+        return false;
+    }
+    delete orderService;
+    orderService = client;
+    subscribeToOrderEvents();
+    return true;
+}
+
+void DatabaseManager::subscribeToOrderEvents() {
+    if (orderEvents || !orderService) {
+        return;
+    }
+    // Connects without blocking, so a service that is down never stalls the GUI thread
+    orderEvents = orderService->subscribe(this);
+    orderEventsSubscribed = false;
+    connect(orderEvents, &QLocalSocket::readyRead, this, &DatabaseManager::readOrderEvents);
+    // errorOccurred covers a failed connect; disconnected a service that went away later
+    connect(orderEvents, &QLocalSocket::errorOccurred, this, &DatabaseManager::dropOrderEvents);
+    connect(orderEvents, &QLocalSocket::disconnected, this, &DatabaseManager::dropOrderEvents);
+}
+
+void DatabaseManager::dropOrderEvents() {
+    if (!orderEvents) {
+        return;
+    }
+    orderEvents->disconnect(this);
+    orderEvents->abort();
+    orderEvents->deleteLater();
+    orderEvents = nullptr;
+    orderEventBuffer.clear();
+    // Status changes made while unsubscribed are not replayed
+    QTimer::singleShot(kResubscribeMs, this, &DatabaseManager::subscribeToOrderEvents);
+}
+
+void DatabaseManager::readOrderEvents() {
+    orderEventBuffer += orderEvents->readAll();
+    QByteArray event;
+    bool corrupt = false;
+    while (OrderProtocol::takeFrame(orderEventBuffer, event, corrupt)) {
+        if (!orderEventsSubscribed) {
+            if (!orderService->acceptsHandshake(event)) {
+                dropOrderEvents();
+                return;
+            }
+            orderEventsSubscribed = true;
+            continue;
+        }
+        QDataStream in(event);
+        in.setVersion(OrderProtocol::kStreamVersion);
+        quint16 op = 0;
+        in >> op;
+        if (Op(op) == Op::OrderStatusChanged) {
+            int orderId = -1;
+            QString status;
+            in >> orderId >> status;
+            if (in.status() == QDataStream::Ok) {
+                emit orderStatusChanged(orderId, status);
+            }
+        }
+    }
+    if (corrupt) {
+        dropOrderEvents();
+    }
+}
+
+bool DatabaseManager::createBaseSchema() {
+    QSqlDatabase db = database();
+    // One transaction for all of it; a first launch otherwise syncs once per statement
+    if (!db.transaction()) {
+        return false;
+    }
+    QSqlQuery query(db);
 
     // Users table
     if (!query.exec("CREATE TABLE IF NOT EXISTS users ("
@@ -21,6 +437,7 @@ bool DatabaseManager::initializeDatabase() {
                     "email TEXT, "
                     "phone TEXT)")) {
         qDebug() << "Create users table error:" << query.lastError().text();
+        db.rollback();
         return false;
     }
 
@@ -34,6 +451,7 @@ bool DatabaseManager::initializeDatabase() {
                     "rent_status TEXT DEFAULT 'occupied', "
                     "FOREIGN KEY(vendor_id) REFERENCES users(id))")) {
         qDebug() << "Create shops table error:" << query.lastError().text();
+        db.rollback();
         return false;
     }
 
@@ -47,6 +465,7 @@ bool DatabaseManager::initializeDatabase() {
                     "available BOOLEAN DEFAULT 1, "
                     "FOREIGN KEY(shop_id) REFERENCES shops(id))")) {
         qDebug() << "Create products table error:" << query.lastError().text();
+        db.rollback();
         return false;
     }
 
@@ -61,6 +480,7 @@ bool DatabaseManager::initializeDatabase() {
                     "FOREIGN KEY(student_id) REFERENCES users(id), "
                     "FOREIGN KEY(shop_id) REFERENCES shops(id))")) {
         qDebug() << "Create orders table error:" << query.lastError().text();
+        db.rollback();
         return false;
     }
 
@@ -74,6 +494,7 @@ bool DatabaseManager::initializeDatabase() {
                     "FOREIGN KEY(order_id) REFERENCES orders(id), "
                     "FOREIGN KEY(product_id) REFERENCES products(id))")) {
         qDebug() << "Create order_items table error:" << query.lastError().text();
+        db.rollback();
         return false;
     }
 
@@ -99,24 +520,72 @@ bool DatabaseManager::initializeDatabase() {
                "SELECT 1, 'Coke', 20.0, 'Beverages' WHERE NOT EXISTS "
                "(SELECT 1 FROM products WHERE name='Coke')");
 
+    return db.commit();
+}
+
+int DatabaseManager::schemaVersion() {
+    QSqlQuery query(database());
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+bool DatabaseManager::runMigrations(int current) {
+    QSqlDatabase db = database();
+
+    for (const Migration &migration : migrations()) {
+        if (migration.version <= current) {
+            continue;
+        }
+
+        if (!db.transaction()) {
+            qDebug() << "Migration" << migration.version << "could not start:" << db.lastError().text();
+            return false;
+        }
+
+        QSqlQuery query(db);
+        for (const QString &statement : migration.statements) {
+            if (!query.exec(statement)) {
+                qDebug() << "Migration" << migration.version << "failed:" << query.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
+
+        // user_version lives in the database header, so it commits atomically with the step
+        if (!query.exec(QString("PRAGMA user_version = %1").arg(migration.version)) || !db.commit()) {
+            qDebug() << "Migration" << migration.version << "commit failed:" << db.lastError().text();
+            db.rollback();
+            return false;
+        }
+
+        qDebug() << "Applied migration" << migration.version << "-" << migration.description;
+        current = migration.version;
+        slowQueries.schemaChanged();
+    }
     return true;
 }
 
 bool DatabaseManager::registerUser(const QString &username, const QString &password,
                                    const QString &userType, const QString &email,
                                    const QString &phone) {
-    QSqlQuery query;
-    query.prepare("INSERT INTO users (username, password, user_type, email, phone) "
-                  "VALUES (?, ?, ?, ?, ?)");
-    query.addBindValue(username);
-    query.addBindValue(password);
-    query.addBindValue(userType.toLower());
-    query.addBindValue(email);
-    query.addBindValue(phone);
+    QueryTimer timer("registerUser");
+    if (orderService) {
+        return orderService->call(Op::RegisterUser, false, username, password, userType, email, phone);
+    }
+    CachedStatement query = statement("registerUser",
+                                      "INSERT INTO users (username, password, user_type, email, phone) "
+                                      "VALUES (?, ?, ?, ?, ?)");
+    query->bindValue(0, username);
+    query->bindValue(1, password);
+    query->bindValue(2, userType.toLower());
+    query->bindValue(3, email);
+    query->bindValue(4, phone);
 
     bool success = query.exec();
     if (!success) {
-        QString error = query.lastError().text();
+        QString error = query->lastError().text();
         qDebug() << "Registration error:" << error;
         if (error.contains("UNIQUE constraint failed") || error.contains("duplicate")) {
             return false;
@@ -126,27 +595,37 @@ bool DatabaseManager::registerUser(const QString &username, const QString &passw
 }
 
 bool DatabaseManager::validateLogin(const QString &username, const QString &password, QString &userType) {
-    QSqlQuery query;
-    query.prepare("SELECT user_type FROM users WHERE username = ? AND password = ?");
-    query.addBindValue(username);
-    query.addBindValue(password);
+    QueryTimer timer("validateLogin");
+    if (orderService) {
+        QPair<bool, QString> reply = orderService->call(Op::ValidateLogin, qMakePair(false, QString()),
+                                                        username, password);
+        userType = reply.second;
+        return reply.first;
+    }
+    CachedStatement query = statement("validateLogin",
+                                      "SELECT user_type FROM users WHERE username = ? AND password = ?");
+    query->bindValue(0, username);
+    query->bindValue(1, password);
 
     if (query.exec() && query.next()) {
-        userType = query.value(0).toString();
+        userType = query->value(0).toString();
         return true;
     }
 
-    qDebug() << "Login failed for user:" << username << "Error:" << query.lastError().text();
+    qDebug() << "Login failed for user:" << username << "Error:" << query->lastError().text();
     return false;
 }
 
 int DatabaseManager::getUserId(const QString &username) {
-    QSqlQuery query;
-    query.prepare("SELECT id FROM users WHERE username = ?");
-    query.addBindValue(username);
+    QueryTimer timer("getUserId");
+    if (orderService) {
+        return orderService->call(Op::GetUserId, -1, username);
+    }
+    CachedStatement query = statement("getUserId", "SELECT id FROM users WHERE username = ?");
+    query->bindValue(0, username);
 
     if (query.exec() && query.next()) {
-        return query.value(0).toInt();
+        return query->value(0).toInt();
     }
 
     qDebug() << "Get user ID failed for:" << username;
@@ -154,276 +633,1166 @@ int DatabaseManager::getUserId(const QString &username) {
 }
 
 bool DatabaseManager::usernameExists(const QString &username) {
-    QSqlQuery query;
-    query.prepare("SELECT COUNT(*) FROM users WHERE username = ?");
-    query.addBindValue(username);
+    QueryTimer timer("usernameExists");
+    if (orderService) {
+        return orderService->call(Op::UsernameExists, false, username);
+    }
+    CachedStatement query = statement("usernameExists", "SELECT COUNT(*) FROM users WHERE username = ?");
+    query->bindValue(0, username);
 
     if (query.exec() && query.next()) {
-        return query.value(0).toInt() > 0;
+        return query->value(0).toInt() > 0;
     }
     return false;
 }
 
 QString DatabaseManager::getUsername(int userId) {
-    QSqlQuery query;
-    query.prepare("SELECT username FROM users WHERE id = ?");
-    query.addBindValue(userId);
+    QueryTimer timer("getUsername");
+    if (orderService) {
+        return orderService->call(Op::GetUsername, QString(), userId);
+    }
+    CachedStatement query = statement("getUsername", "SELECT username FROM users WHERE id = ?");
+    query->bindValue(0, userId);
 
     if (query.exec() && query.next()) {
-        return query.value(0).toString();
+        return query->value(0).toString();
     }
     return "";
 }
 
 bool DatabaseManager::registerShop(int vendorId, const QString &shopName, const QString &slotNumber, const QString &description) {
-    QSqlQuery query;
-    query.prepare("INSERT INTO shops (vendor_id, shop_name, slot_number, description) "
-                  "VALUES (?, ?, ?, ?)");
-    query.addBindValue(vendorId);
-    query.addBindValue(shopName);
-    query.addBindValue(slotNumber);
-    query.addBindValue(description);
+    QueryTimer timer("registerShop");
+    if (orderService) {
+        return orderService->call(Op::RegisterShop, false, vendorId, shopName, slotNumber, description);
+    }
+    CachedStatement query = statement("registerShop",
+                                      "INSERT INTO shops (vendor_id, shop_name, slot_number, description) "
+                                      "VALUES (?, ?, ?, ?)");
+    query->bindValue(0, vendorId);
+    query->bindValue(1, shopName);
+    query->bindValue(2, slotNumber);
+    query->bindValue(3, description);
 
     bool success = query.exec();
     if (!success) {
-        qDebug() << "Shop registration error:" << query.lastError().text();
+        qDebug() << "Shop registration error:" << query->lastError().text();
+    } else {
+        invalidateCatalog();
     }
     return success;
 }
 
 int DatabaseManager::getShopId(int vendorId) {
-    QSqlQuery query;
-    query.prepare("SELECT id FROM shops WHERE vendor_id = ?");
-    query.addBindValue(vendorId);
+    QueryTimer timer("getShopId");
+    if (orderService) {
+        return orderService->call(Op::GetShopId, -1, vendorId);
+    }
+    CachedStatement query = statement("getShopId", "SELECT id FROM shops WHERE vendor_id = ?");
+    query->bindValue(0, vendorId);
 
     if (query.exec() && query.next()) {
-        return query.value(0).toInt();
+        return query->value(0).toInt();
     }
     return -1;
 }
 
 QString DatabaseManager::getShopName(int shopId) {
-    QSqlQuery query;
-    query.prepare("SELECT shop_name FROM shops WHERE id = ?");
-    query.addBindValue(shopId);
+    QueryTimer timer("getShopName");
+    if (orderService) {
+        return orderService->call(Op::GetShopName, QString(), shopId);
+    }
+    CachedStatement query = statement("getShopName", "SELECT shop_name FROM shops WHERE id = ?");
+    query->bindValue(0, shopId);
 
     if (query.exec() && query.next()) {
-        return query.value(0).toString();
+        return query->value(0).toString();
     }
     return "";
 }
 
 QVector<QPair<int, QString>> DatabaseManager::getAllShops() {
+    QueryTimer timer("getAllShops");
+    if (orderService) {
+        return orderService->call(Op::GetAllShops, QVector<QPair<int, QString>>());
+    }
     QVector<QPair<int, QString>> shops;
-    QSqlQuery query("SELECT id, shop_name FROM shops WHERE rent_status = 'occupied'");
+    CachedStatement query = statement("getAllShops",
+                                      "SELECT id, shop_name FROM shops WHERE rent_status = 'occupied'");
 
-    while (query.next()) {
-        shops.append(qMakePair(query.value(0).toInt(), query.value(1).toString()));
+    if (query.exec()) {
+        while (query.next()) {
+            shops.append(qMakePair(query->value(0).toInt(), query->value(1).toString()));
+        }
     }
+    timer.setRows(shops.size());
     return shops;
 }
 
 bool DatabaseManager::addProduct(int shopId, const QString &name, double price, const QString &category) {
-    QSqlQuery query;
-    query.prepare("INSERT INTO products (shop_id, name, price, category) "
-                  "VALUES (?, ?, ?, ?)");
-    query.addBindValue(shopId);
-    query.addBindValue(name);
-    query.addBindValue(price);
-    query.addBindValue(category);
+    QueryTimer timer("addProduct");
+    if (orderService) {
+        return orderService->call(Op::AddProduct, false, shopId, name, price, category);
+    }
+    CachedStatement query = statement("addProduct",
+                                      "INSERT INTO products (shop_id, name, price, category) "
+                                      "VALUES (?, ?, ?, ?)");
+    query->bindValue(0, shopId);
+    query->bindValue(1, name);
+    query->bindValue(2, price);
+    query->bindValue(3, category);
 
     bool success = query.exec();
     if (!success) {
-        qDebug() << "Add product error:" << query.lastError().text();
+        qDebug() << "Add product error:" << query->lastError().text();
+    } else {
+        invalidateCatalog();
     }
     return success;
 }
 
 bool DatabaseManager::updateProductAvailability(int productId, bool available) {
-    QSqlQuery query;
-    query.prepare("UPDATE products SET available = ? WHERE id = ?");
-    query.addBindValue(available);
-    query.addBindValue(productId);
-    return query.exec();
+    QueryTimer timer("updateProductAvailability");
+    if (orderService) {
+        return orderService->call(Op::UpdateProductAvailability, false, productId, available);
+    }
+    CachedStatement query = statement("updateProductAvailability",
+                                      "UPDATE products SET available = ? WHERE id = ?");
+    query->bindValue(0, available);
+    query->bindValue(1, productId);
+
+    bool success = query.exec();
+    if (success) {
+        invalidateCatalog();
+    }
+    return success;
 }
 
-QVector<QVector<QVariant>> DatabaseManager::getProductsByShop(int shopId) {
-    QVector<QVector<QVariant>> products;
-    QSqlQuery query;
-    query.prepare("SELECT id, name, price, category, available FROM products WHERE shop_id = ? AND available = 1");
-    query.addBindValue(shopId);
+QVector<Product> DatabaseManager::getProductsByShop(int shopId) {
+    QueryTimer timer("getProductsByShop");
+    if (orderService) {
+        return orderService->call(Op::GetProductsByShop, QVector<Product>(), shopId);
+    }
+    QVector<Product> products;
+    CachedStatement query = statement("getProductsByShop",
+                                      "SELECT id, name, price, category, available FROM products WHERE shop_id = ? AND available = 1");
+    query->bindValue(0, shopId);
 
     if (query.exec()) {
         while (query.next()) {
-            QVector<QVariant> product;
-            for (int i = 0; i < 5; ++i) {
-                product.append(query.value(i));
-            }
-            products.append(product);
+            Product product;
+            product.id = query->value(0).toInt();
+            product.shopId = shopId;
+            product.name = query->value(1).toString();
+            product.price = query->value(2).toDouble();
+            product.category = query->value(3).toString();
+            product.available = query->value(4).toBool();
+            products.append(std::move(product));
         }
     }
+    timer.setRows(products.size());
     return products;
 }
 
-QVector<QVector<QVariant>> DatabaseManager::getAllAvailableProducts() {
-    QVector<QVector<QVariant>> products;
-    QSqlQuery query("SELECT p.id, p.name, s.shop_name, p.price, p.category, p.available, s.id "
-                    "FROM products p "
-                    "JOIN shops s ON p.shop_id = s.id "
-                    "WHERE p.available = 1");
+QVector<Product> DatabaseManager::getAllAvailableProducts() {
+    QueryTimer timer("getAllAvailableProducts");
+    if (orderService) {
+        return orderService->call(Op::GetAllAvailableProducts, QVector<Product>());
+    }
+    QVector<Product> products;
+    CachedStatement query = statement("getAllAvailableProducts",
+                                      "SELECT p.id, p.name, s.shop_name, p.price, p.category, p.available, s.id "
+                                      "FROM products p "
+                                      "JOIN shops s ON p.shop_id = s.id "
+                                      "WHERE p.available = 1");
 
     if (query.exec()) {
         while (query.next()) {
-            QVector<QVariant> product;
-            for (int i = 0; i < 7; ++i) {
-                product.append(query.value(i));
+            Product product;
+            product.id = query->value(0).toInt();
+            product.name = query->value(1).toString();
+            product.shopName = query->value(2).toString();
+            product.price = query->value(3).toDouble();
+            product.category = query->value(4).toString();
+            product.available = query->value(5).toBool();
+            product.shopId = query->value(6).toInt();
+            products.append(std::move(product));
+        }
+    }
+    timer.setRows(products.size());
+    return products;
+}
+
+QFuture<ProductImportResult> DatabaseManager::importProductsAsync(int shopId, const QString &filePath,
+                                                                  std::shared_ptr<ProductImportResult> summary) {
+    return QtConcurrent::run(&workerPool, [this, shopId, filePath, summary](QPromise<ProductImportResult> &promise) {
+        importProducts(promise, shopId, filePath, summary.get());
+    });
+}
+
+void DatabaseManager::importProducts(QPromise<ProductImportResult> &promise, int shopId, const QString &filePath,
+                                     ProductImportResult *summary) {
+    QueryTimer timer("importProducts");
+    auto finish = [&promise, summary](const ProductImportResult &result) {
+        if (summary) {
+            *summary = result;
+        }
+        promise.addResult(result);
+    };
+    if (orderService) {
+        // The service reads the file itself; progress and cancel stay local to the service
+        ProductImportResult failed;
+        failed.failed = true;
+        failed.errors.append({0, "Order service unreachable"});
+        finish(orderService->call(Op::ImportProducts, failed, shopId, QFileInfo(filePath).absoluteFilePath()));
+        return;
+    }
+    ProductImportResult result;
+    auto reject = [&result](int line, const QString &message) {
+        ++result.rejected;
+        if (result.errors.size() < kMaxReportedImportErrors) {
+            result.errors.append({line, message});
+        }
+    };
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        reject(0, "Cannot open file: " + file.errorString());
+        result.failed = true;
+        finish(result);
+        return;
+    }
+    const qint64 fileSize = qMax<qint64>(1, file.size());
+    promise.setProgressRange(0, 1000);
+
+    QSqlDatabase db = database();
+    QVector<Product> batch;
+    batch.reserve(kImportRowsPerTransaction);
+
+    // Full chunks all reuse one cached multi-row INSERT; a short final chunk is prepared for that
+    // one use and never cached, so the cache holds one import statement whatever the file size
+    auto commitBatch = [&]() -> bool {
+        if (batch.isEmpty()) {
+            return true;
+        }
+        if (!beginImmediate(db)) {
+            return false;
+        }
+        bool ok = true;
+        for (int offset = 0; ok && offset < batch.size(); offset += kImportRowsPerInsert) {
+            int rows = qMin(kImportRowsPerInsert, int(batch.size()) - offset);
+
+            QString sql = "INSERT INTO products (shop_id, name, price, category, available) VALUES ";
+            for (int i = 0; i < rows; ++i) {
+                sql += (i == 0) ? "(?, ?, ?, ?, ?)" : ", (?, ?, ?, ?, ?)";
+            }
+
+            QSqlQuery shortInsert(db);
+            if (rows < kImportRowsPerInsert) {
+                shortInsert.prepare(sql);
+            }
+            CachedStatement insert = rows == kImportRowsPerInsert ? statement("importProducts", sql)
+                                                                  : CachedStatement(shortInsert);
+            for (int i = 0; i < rows; ++i) {
+                const Product &product = batch[offset + i];
+                insert->bindValue(i * 5, shopId);
+                insert->bindValue(i * 5 + 1, product.name);
+                insert->bindValue(i * 5 + 2, product.price);
+                insert->bindValue(i * 5 + 3, product.category);
+                insert->bindValue(i * 5 + 4, product.available);
+            }
+            ok = insert.exec();
+            if (!ok) {
+                qDebug() << "Import products error:" << insert->lastError().text();
+            }
+        }
+        if (!ok || !db.commit()) {
+            db.rollback();
+            return false;
+        }
+        result.imported += batch.size();
+        batch.clear();
+        return true;
+    };
+
+    CsvReader reader(&file);
+    QStringList fields;
+    bool firstRow = true;
+    while (reader.readRow(fields)) {
+        int line = reader.rowLine();
+
+        // Only a first row naming the name and price columns is a header; any other first row
+        // is data and is validated like the rest
+        if (std::exchange(firstRow, false)
+            && fields.value(0).trimmed().compare("name", Qt::CaseInsensitive) == 0
+            && fields.value(1).trimmed().compare("price", Qt::CaseInsensitive) == 0) {
+            continue;
+        }
+
+        bool ok = false;
+        double price = fields.value(1).trimmed().toDouble(&ok);
+
+        Product product;
+        product.name = fields.value(0).trimmed();
+        product.price = price;
+        product.category = fields.value(2).trimmed();
+        if (fields.size() < 2 || fields.size() > 4) {
+            reject(line, QString("Expected 2 to 4 columns, found %1").arg(fields.size()));
+            continue;
+        }
+        if (product.name.isEmpty()) {
+            reject(line, "Missing product name");
+            continue;
+        }
+        if (!ok || price <= 0) {
+            reject(line, QString("Invalid price '%1'").arg(fields.value(1).trimmed()));
+            continue;
+        }
+        if (fields.size() == 4) {
+            QString available = fields.value(3).trimmed().toLower();
+            if (available == "1" || available == "yes" || available == "true") {
+                product.available = true;
+            } else if (available == "0" || available == "no" || available == "false") {
+                product.available = false;
+            } else {
+                reject(line, QString("Invalid availability '%1'").arg(fields.value(3).trimmed()));
+                continue;
+            }
+        }
+        batch.append(std::move(product));
+
+        if (batch.size() == kImportRowsPerTransaction) {
+            if (!commitBatch()) {
+                result.failed = true;
+                break;
+            }
+            promise.setProgressValue(int(file.pos() * 1000 / fileSize));
+            if (promise.isCanceled()) {
+                result.canceled = true;
+                break;
+            }
+        }
+    }
+
+    if (!result.failed && !result.canceled && !commitBatch()) {
+        result.failed = true;
+    }
+    if (result.imported > 0) {
+        invalidateCatalog();
+    }
+    promise.setProgressValue(1000);
+    finish(result);
+}
+
+QFuture<OrderExportResult> DatabaseManager::exportOrdersAsync(int shopId, const QDate &month, ExportFormat format,
+                                                              const QString &filePath) {
+    return QtConcurrent::run(&workerPool, [this, shopId, month, format, filePath](QPromise<OrderExportResult> &promise) {
+        exportOrders(promise, shopId, month, format, filePath);
+    });
+}
+
+void DatabaseManager::exportOrders(QPromise<OrderExportResult> &promise, int shopId, const QDate &month,
+                                   ExportFormat format, const QString &filePath) {
+    QueryTimer timer("exportOrders");
+    if (orderService) {
+        OrderExportResult failed;
+        failed.failed = true;
+        failed.error = "Order service unreachable";
+        promise.addResult(orderService->call(Op::ExportOrders, failed, shopId, month, format,
+                                             QFileInfo(filePath).absoluteFilePath()));
+        return;
+    }
+    OrderExportResult result;
+    auto fail = [&promise, &result](const QString &error) {
+        result.failed = true;
+        result.error = error;
+        promise.addResult(result);
+    };
+
+    QDate first(month.year(), month.month(), 1);
+    QString from = first.toString("yyyy-MM-dd") + " 00:00:00";
+    QString to = first.addMonths(1).toString("yyyy-MM-dd") + " 00:00:00";
+
+    {
+        CachedStatement count = statement("exportOrders.count",
+                                          QString("SELECT COUNT(*) FROM %1 o "
+                                                  "WHERE o.shop_id = ? AND o.order_date >= ? AND o.order_date < ?")
+                                              .arg(kAllOrders));
+        count->bindValue(0, shopId);
+        count->bindValue(1, from);
+        count->bindValue(2, to);
+        if (count.exec() && count.next()) {
+            promise.setProgressRange(0, qMax(1, count->value(0).toInt()));
+        }
+    }
+
+    // Written to a temporary file that only replaces filePath on commit()
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        fail("Cannot open file: " + file.errorString());
+        return;
+    }
+
+    QByteArray buffer;
+    buffer.reserve(kExportBufferBytes + 4096);
+    auto flush = [&file, &buffer]() -> bool {
+        bool ok = file.write(buffer) == buffer.size();
+        buffer.clear();
+        return ok;
+    };
+
+    if (format == ExportFormat::Csv) {
+        buffer += "order_id,order_date,customer,status,total_amount,items\n";
+    }
+
+    CachedStatement query = statement("exportOrders",
+                                      QString("SELECT o.id, o.order_date, u.username, o.status, o.total_amount, "
+                                              "o.items_summary "
+                                              "FROM %1 o "
+                                              "JOIN users u ON o.student_id = u.id "
+                                              "WHERE o.shop_id = ? AND o.order_date >= ? AND o.order_date < ? "
+                                              "ORDER BY o.order_date, o.id")
+                                          .arg(kAllOrders));
+    query->bindValue(0, shopId);
+    query->bindValue(1, from);
+    query->bindValue(2, to);
+    if (!query.exec()) {
+        fail("Export query failed: " + query->lastError().text());
+        return;
+    }
+
+    while (query.next()) {
+        int id = query->value(0).toInt();
+        QString orderDate = query->value(1).toString();
+        QString customer = query->value(2).toString();
+        QString status = query->value(3).toString();
+        double total = query->value(4).toDouble();
+        QString items = query->value(5).toString();
+
+        if (format == ExportFormat::Csv) {
+            // Concatenated rather than arg()-chained so '%' in user data is never substituted
+            QString line = QString::number(id) + ',' + csvField(orderDate) + ',' + csvField(customer) + ','
+                           + csvField(status) + ',' + QString::number(total, 'f', 2) + ','
+                           + csvField(items) + '\n';
+            buffer += line.toUtf8();
+        } else {
+            QJsonObject row;
+            row["order_id"] = id;
+            row["order_date"] = orderDate;
+            row["customer"] = customer;
+            row["status"] = status;
+            row["total_amount"] = total;
+            row["items"] = items;
+            buffer += QJsonDocument(row).toJson(QJsonDocument::Compact);
+            buffer += '\n';
+        }
+
+        if (buffer.size() >= kExportBufferBytes && !flush()) {
+            fail("Write failed: " + file.errorString());
+            return;
+        }
+        if (++result.rows % kExportProgressRows == 0) {
+            promise.setProgressValue(int(result.rows));
+            if (promise.isCanceled()) {
+                file.cancelWriting();
+                return;
             }
-            products.append(product);
         }
     }
+
+    if (!flush() || !file.commit()) {
+        fail("Write failed: " + file.errorString());
+        return;
+    }
+    promise.setProgressValue(int(result.rows));
+    promise.addResult(result);
+}
+
+QVector<Product> DatabaseManager::searchProducts(const QString &text, int limit) {
+    QueryTimer timer("searchProducts");
+    if (orderService) {
+        return orderService->call(Op::SearchProducts, QVector<Product>(), text, limit);
+    }
+    QVector<Product> products;
+
+    // Every word becomes a quoted prefix token, so "chi bir" matches "Chicken Biryani"
+    static const QRegularExpression separators("[^\\w]+", QRegularExpression::UseUnicodePropertiesOption);
+    QStringList tokens;
+    for (const QString &word : text.split(separators, Qt::SkipEmptyParts)) {
+        tokens.append(QString("\"%1\"*").arg(word));
+    }
+    if (tokens.isEmpty()) {
+        return products;
+    }
+
+    // Rank inside the FTS index first so only the top rows are joined; name outweighs category and shop
+    CachedStatement query = statement("searchProducts",
+                                      "SELECT p.id, p.name, s.shop_name, p.price, p.category, p.available, s.id "
+                                      "FROM (SELECT rowid, rank FROM products_fts "
+                                      "WHERE products_fts MATCH ? AND rank MATCH 'bm25(10.0, 2.0, 1.0)' "
+                                      "ORDER BY rank LIMIT ?) f "
+                                      "JOIN products p ON p.id = f.rowid "
+                                      "JOIN shops s ON p.shop_id = s.id "
+                                      "ORDER BY f.rank");
+    query->bindValue(0, tokens.join(' '));
+    query->bindValue(1, limit);
+
+    if (query.exec()) {
+        while (query.next()) {
+            Product product;
+            product.id = query->value(0).toInt();
+            product.name = query->value(1).toString();
+            product.shopName = query->value(2).toString();
+            product.price = query->value(3).toDouble();
+            product.category = query->value(4).toString();
+            product.available = query->value(5).toBool();
+            product.shopId = query->value(6).toInt();
+            products.append(std::move(product));
+        }
+    } else {
+        qDebug() << "Product search error:" << query->lastError().text();
+    }
+    timer.setRows(products.size());
     return products;
 }
 
+int DatabaseManager::placeOrder(int studentId, const QVector<OrderLine> &cart) {
+    QueryTimer timer("placeOrder");
+    if (orderService) {
+        return orderService->call(Op::PlaceOrder, -1, studentId, cart);
+    }
+    if (cart.isEmpty()) {
+        return -1;
+    }
+
+    int shopId = cart.first().shopId;
+    double totalAmount = 0.0;
+    for (const OrderLine &line : cart) {
+        if (line.shopId != shopId || line.quantity <= 0) {
+            qDebug() << "Place order rejected: cart must hold positive quantities from one shop";
+            return -1;
+        }
+        totalAmount += line.quantity * line.price;
+    }
+
+    QSqlDatabase db = database();
+    if (!beginImmediate(db)) {
+        return -1;
+    }
+
+    int orderId = -1;
+    {
+        CachedStatement header = statement("placeOrder.header",
+                                           "INSERT INTO orders (student_id, shop_id, total_amount) VALUES (?, ?, ?)");
+        header->bindValue(0, studentId);
+        header->bindValue(1, shopId);
+        header->bindValue(2, totalAmount);
+        if (header.exec()) {
+            orderId = header->lastInsertId().toInt();
+        } else {
+            qDebug() << "Place order header error:" << header->lastError().text();
+        }
+    }
+
+    // One multi-row INSERT per chunk; chunks keep the bind count under SQLite's variable limit
+    for (int offset = 0; orderId != -1 && offset < cart.size(); offset += kMaxOrderItemsPerInsert) {
+        int rows = qMin(kMaxOrderItemsPerInsert, int(cart.size()) - offset);
+
+        QString sql = "INSERT INTO order_items (order_id, product_id, quantity, price) VALUES ";
+        for (int i = 0; i < rows; ++i) {
+            sql += (i == 0) ? "(?, ?, ?, ?)" : ", (?, ?, ?, ?)";
+        }
+
+        CachedStatement items = statement(QString("placeOrder.items.%1").arg(rows), sql);
+        for (int i = 0; i < rows; ++i) {
+            const OrderLine &line = cart[offset + i];
+            items->bindValue(i * 4, orderId);
+            items->bindValue(i * 4 + 1, line.productId);
+            items->bindValue(i * 4 + 2, line.quantity);
+            items->bindValue(i * 4 + 3, line.price);
+        }
+        if (!items.exec()) {
+            qDebug() << "Place order items error:" << items->lastError().text();
+            orderId = -1;
+        }
+    }
+
+    if (orderId != -1) {
+        CachedStatement saved = statement("placeOrder.clearCart", "DELETE FROM saved_carts WHERE student_id = ?");
+        saved->bindValue(0, studentId);
+        if (!saved.exec()) {
+            qDebug() << "Place order cart error:" << saved->lastError().text();
+            orderId = -1;
+        }
+    }
+
+    if (orderId == -1 || !db.commit()) {
+        db.rollback();
+        return -1;
+    }
+    return orderId;
+}
+
 int DatabaseManager::createOrder(int studentId, int shopId, double totalAmount) {
-    QSqlQuery query;
-    query.prepare("INSERT INTO orders (student_id, shop_id, total_amount) VALUES (?, ?, ?)");
-    query.addBindValue(studentId);
-    query.addBindValue(shopId);
-    query.addBindValue(totalAmount);
+    QueryTimer timer("createOrder");
+    if (orderService) {
+        return orderService->call(Op::CreateOrder, -1, studentId, shopId, totalAmount);
+    }
+    CachedStatement query = statement("createOrder",
+                                      "INSERT INTO orders (student_id, shop_id, total_amount) VALUES (?, ?, ?)");
+    query->bindValue(0, studentId);
+    query->bindValue(1, shopId);
+    query->bindValue(2, totalAmount);
 
     if (query.exec()) {
-        return query.lastInsertId().toInt();
+        return query->lastInsertId().toInt();
     }
     return -1;
 }
 
 bool DatabaseManager::addOrderItem(int orderId, int productId, int quantity, double price) {
-    QSqlQuery query;
-    query.prepare("INSERT INTO order_items (order_id, product_id, quantity, price) VALUES (?, ?, ?, ?)");
-    query.addBindValue(orderId);
-    query.addBindValue(productId);
-    query.addBindValue(quantity);
-    query.addBindValue(price);
+    QueryTimer timer("addOrderItem");
+    if (orderService) {
+        return orderService->call(Op::AddOrderItem, false, orderId, productId, quantity, price);
+    }
+    CachedStatement query = statement("addOrderItem",
+                                      "INSERT INTO order_items (order_id, product_id, quantity, price) VALUES (?, ?, ?, ?)");
+    query->bindValue(0, orderId);
+    query->bindValue(1, productId);
+    query->bindValue(2, quantity);
+    query->bindValue(3, price);
     return query.exec();
 }
 
 bool DatabaseManager::updateOrderStatus(int orderId, const QString &status) {
-    QSqlQuery query;
-    query.prepare("UPDATE orders SET status = ? WHERE id = ?");
-    query.addBindValue(status);
-    query.addBindValue(orderId);
-    return query.exec();
+    QueryTimer timer("updateOrderStatus");
+    if (orderService) {
+        return orderService->call(Op::UpdateOrderStatus, false, orderId, status);
+    }
+    CachedStatement query = statement("updateOrderStatus", "UPDATE orders SET status = ? WHERE id = ?");
+    query->bindValue(0, status);
+    query->bindValue(1, orderId);
+    if (!query.exec()) {
+        return false;
+    }
+    // Inside the order service, OrderServer relays this to every subscribed kiosk
+    if (query->numRowsAffected() > 0) {
+        emit orderStatusChanged(orderId, status);
+    }
+    return true;
 }
 
-QVector<QVector<QVariant>> DatabaseManager::getOrdersByStudent(int studentId) {
-    QVector<QVector<QVariant>> orders;
-    QSqlQuery query;
-    query.prepare("SELECT o.id, s.shop_name, o.total_amount, o.status, o.order_date "
-                  "FROM orders o "
-                  "JOIN shops s ON o.shop_id = s.id "
-                  "WHERE o.student_id = ? "
-                  "ORDER BY o.order_date DESC");
-    query.addBindValue(studentId);
+QVector<OrderSummary> DatabaseManager::getOrdersByStudent(int studentId) {
+    QueryTimer timer("getOrdersByStudent");
+    if (orderService) {
+        return orderService->call(Op::GetOrdersByStudent, QVector<OrderSummary>(), studentId);
+    }
+    QVector<OrderSummary> orders;
+    CachedStatement query = statement("getOrdersByStudent",
+                                      "SELECT o.id, s.shop_name, o.total_amount, o.status, o.order_date "
+                                      "FROM orders o "
+                                      "JOIN shops s ON o.shop_id = s.id "
+                                      "WHERE o.student_id = ? "
+                                      "ORDER BY o.order_date DESC");
+    query->bindValue(0, studentId);
 
     if (query.exec()) {
         while (query.next()) {
-            QVector<QVariant> order;
-            for (int i = 0; i < 5; ++i) {
-                order.append(query.value(i));
-            }
-            orders.append(order);
+            OrderSummary order;
+            order.id = query->value(0).toInt();
+            order.shopName = query->value(1).toString();
+            order.totalAmount = query->value(2).toDouble();
+            order.status = query->value(3).toString();
+            order.orderDate = query->value(4).toDateTime();
+            orders.append(std::move(order));
         }
     }
+    timer.setRows(orders.size());
     return orders;
 }
 
-QVector<QVector<QVariant>> DatabaseManager::getOrdersByShop(int shopId) {
-    QVector<QVector<QVariant>> orders;
-    QSqlQuery query;
-    query.prepare("SELECT o.id, u.username, o.total_amount, o.status, o.order_date, "
-                  "(SELECT GROUP_CONCAT(p.name || ' x ' || oi.quantity) "
-                  "FROM order_items oi "
-                  "JOIN products p ON oi.product_id = p.id "
-                  "WHERE oi.order_id = o.id) as items "
-                  "FROM orders o "
-                  "JOIN users u ON o.student_id = u.id "
-                  "WHERE o.shop_id = ? "
-                  "ORDER BY o.order_date DESC");
-    query.addBindValue(shopId);
+QVector<OrderSummary> DatabaseManager::getOrdersByShop(int shopId) {
+    QueryTimer timer("getOrdersByShop");
+    if (orderService) {
+        return orderService->call(Op::GetOrdersByShop, QVector<OrderSummary>(), shopId);
+    }
+    QVector<OrderSummary> orders;
+    CachedStatement query = statement("getOrdersByShop",
+                                      "SELECT o.id, u.username, o.total_amount, o.status, o.order_date, o.items_summary "
+                                      "FROM orders o "
+                                      "JOIN users u ON o.student_id = u.id "
+                                      "WHERE o.shop_id = ? "
+                                      "ORDER BY o.order_date DESC");
+    query->bindValue(0, shopId);
 
     if (query.exec()) {
         while (query.next()) {
-            QVector<QVariant> order;
-            for (int i = 0; i < 6; ++i) {
-                order.append(query.value(i));
-            }
-            orders.append(order);
+            OrderSummary order;
+            order.id = query->value(0).toInt();
+            order.customer = query->value(1).toString();
+            order.totalAmount = query->value(2).toDouble();
+            order.status = query->value(3).toString();
+            order.orderDate = query->value(4).toDateTime();
+            order.items = query->value(5).toString();
+            orders.append(std::move(order));
         }
     }
+    timer.setRows(orders.size());
     return orders;
 }
 
-QVector<QVector<QVariant>> DatabaseManager::getOrderItems(int orderId) {
-    QVector<QVector<QVariant>> items;
-    QSqlQuery query;
-    query.prepare("SELECT p.name, oi.quantity, oi.price "
+QVector<OrderItem> DatabaseManager::getOrderItems(int orderId, bool includeArchived) {
+    QueryTimer timer("getOrderItems");
+    if (orderService) {
+        return orderService->call(Op::GetOrderItems, QVector<OrderItem>(), orderId, includeArchived);
+    }
+    QVector<OrderItem> items;
+    QString sql = "SELECT p.name, oi.quantity, oi.price "
                   "FROM order_items oi "
                   "JOIN products p ON oi.product_id = p.id "
-                  "WHERE oi.order_id = ?");
-    query.addBindValue(orderId);
+                  "WHERE oi.order_id = ?";
+    if (includeArchived) {
+        sql += " UNION ALL "
+               "SELECT p.name, oi.quantity, oi.price "
+               "FROM order_items_archive oi "
+               "JOIN products p ON oi.product_id = p.id "
+               "WHERE oi.order_id = ?";
+    }
+    CachedStatement query = statement(includeArchived ? "getOrderItems.all" : "getOrderItems.hot", sql);
+    query->bindValue(0, orderId);
+    if (includeArchived) {
+        query->bindValue(1, orderId);
+    }
 
     if (query.exec()) {
         while (query.next()) {
-            QVector<QVariant> item;
-            for (int i = 0; i < 3; ++i) {
-                item.append(query.value(i));
-            }
-            items.append(item);
+            OrderItem item;
+            item.productName = query->value(0).toString();
+            item.quantity = query->value(1).toInt();
+            item.price = query->value(2).toDouble();
+            items.append(std::move(item));
         }
     }
+    timer.setRows(items.size());
     return items;
 }
 
-double DatabaseManager::getTotalRevenue(int shopId) {
-    QSqlQuery query;
-    query.prepare("SELECT SUM(total_amount) FROM orders WHERE shop_id = ? AND status = 'completed'");
-    query.addBindValue(shopId);
+bool DatabaseManager::saveCartItem(int studentId, int productId, int quantity) {
+    QueryTimer timer("saveCartItem");
+    if (orderService) {
+        return orderService->call(Op::SaveCartItem, false, studentId, productId, quantity);
+    }
+    if (quantity <= 0) {
+        CachedStatement query = statement("saveCartItem.delete",
+                                          "DELETE FROM saved_carts WHERE student_id = ? AND product_id = ?");
+        query->bindValue(0, studentId);
+        query->bindValue(1, productId);
+        return query.exec();
+    }
+    CachedStatement query = statement("saveCartItem",
+                                      "INSERT INTO saved_carts (student_id, product_id, quantity) VALUES (?, ?, ?) "
+                                      "ON CONFLICT(student_id, product_id) DO UPDATE SET quantity = excluded.quantity");
+    query->bindValue(0, studentId);
+    query->bindValue(1, productId);
+    query->bindValue(2, quantity);
+    if (!query.exec()) {
+        qDebug() << "Save cart item error:" << query->lastError().text();
+        return false;
+    }
+    return true;
+}
 
-    if (query.exec() && query.next()) {
-        return query.value(0).toDouble();
+bool DatabaseManager::clearSavedCart(int studentId) {
+    QueryTimer timer("clearSavedCart");
+    if (orderService) {
+        return orderService->call(Op::ClearSavedCart, false, studentId);
     }
-    return 0.0;
+    CachedStatement query = statement("clearSavedCart", "DELETE FROM saved_carts WHERE student_id = ?");
+    query->bindValue(0, studentId);
+    return query.exec();
 }
 
-double DatabaseManager::getTodayRevenue(int shopId) {
-    QSqlQuery query;
-    query.prepare("SELECT SUM(total_amount) FROM orders WHERE shop_id = ? AND status = 'completed' AND DATE(order_date) = DATE('now')");
-    query.addBindValue(shopId);
+QVector<SavedCartItem> DatabaseManager::getSavedCart(int studentId) {
+    QueryTimer timer("getSavedCart");
+    if (orderService) {
+        return orderService->call(Op::GetSavedCart, QVector<SavedCartItem>(), studentId);
+    }
+    QVector<SavedCartItem> items;
+    CachedStatement query = statement("getSavedCart",
+                                      "SELECT p.id, p.name, s.shop_name, p.price, p.category, s.id, c.quantity "
+                                      "FROM saved_carts c "
+                                      "JOIN products p ON c.product_id = p.id "
+                                      "JOIN shops s ON p.shop_id = s.id "
+                                      "WHERE c.student_id = ? AND p.available = 1 "
+                                      "ORDER BY c.id");
+    query->bindValue(0, studentId);
 
-    if (query.exec() && query.next()) {
-        return query.value(0).toDouble();
+    if (query.exec()) {
+        while (query.next()) {
+            SavedCartItem item;
+            item.product.id = query->value(0).toInt();
+            item.product.name = query->value(1).toString();
+            item.product.shopName = query->value(2).toString();
+            item.product.price = query->value(3).toDouble();
+            item.product.category = query->value(4).toString();
+            item.product.shopId = query->value(5).toInt();
+            item.quantity = query->value(6).toInt();
+            items.append(std::move(item));
+        }
     }
-    return 0.0;
+    timer.setRows(items.size());
+    return items;
 }
 
-int DatabaseManager::getTotalOrdersCount(int shopId) {
-    QSqlQuery query;
-    query.prepare("SELECT COUNT(*) FROM orders WHERE shop_id = ?");
-    query.addBindValue(shopId);
+OrderPage DatabaseManager::getOrdersByStudentPage(int studentId, const OrderCursor &after, int pageSize,
+                                                  bool includeArchived) {
+    QueryTimer timer("getOrdersByStudentPage");
+    if (orderService) {
+        return orderService->call(Op::GetOrdersByStudentPage, OrderPage(), studentId, after, pageSize,
+                                  includeArchived);
+    }
+    OrderPage page;
+    QString id = QString("getOrdersByStudentPage.%1.%2")
+                     .arg(after.isNull() ? "first" : "after")
+                     .arg(includeArchived ? "all" : "hot");
+    CachedStatement query = statement(id,
+                                      QString("SELECT o.id, s.shop_name, o.total_amount, o.status, o.order_date "
+                                              "FROM %1 o "
+                                              "JOIN shops s ON o.shop_id = s.id "
+                                              "WHERE o.student_id = ? %2"
+                                              "ORDER BY o.order_date DESC, o.id DESC "
+                                              "LIMIT ?")
+                                          .arg(includeArchived ? kAllOrders : "orders")
+                                          .arg(after.isNull() ? "" : "AND (o.order_date, o.id) < (?, ?) "));
+    int bind = 0;
+    query->bindValue(bind++, studentId);
+    if (!after.isNull()) {
+        query->bindValue(bind++, after.orderDate);
+        query->bindValue(bind++, after.id);
+    }
+    // One extra row tells us whether another page exists
+    query->bindValue(bind++, pageSize + 1);
+
+    page.orders.reserve(pageSize);
+    if (query.exec()) {
+        while (query.next()) {
+            if (page.orders.size() == pageSize) {
+                page.hasMore = true;
+                break;
+            }
+            OrderSummary order;
+            order.id = query->value(0).toInt();
+            order.shopName = query->value(1).toString();
+            order.totalAmount = query->value(2).toDouble();
+            order.status = query->value(3).toString();
+            order.orderDate = query->value(4).toDateTime();
+            page.next = {query->value(4).toString(), order.id};
+            page.orders.append(std::move(order));
+        }
+    }
+    timer.setRows(page.orders.size());
+    return page;
+}
+
+OrderPage DatabaseManager::getOrdersByShopPage(int shopId, const OrderCursor &after, int pageSize,
+                                               const QString &status, bool includeArchived) {
+    QueryTimer timer("getOrdersByShopPage");
+    if (orderService) {
+        return orderService->call(Op::GetOrdersByShopPage, OrderPage(), shopId, after, pageSize, status,
+                                  includeArchived);
+    }
+    OrderPage page;
+    QString id = QString("getOrdersByShopPage.%1.%2.%3")
+                     .arg(after.isNull() ? "first" : "after")
+                     .arg(status.isEmpty() ? "all" : "status")
+                     .arg(includeArchived ? "all" : "hot");
+    CachedStatement query = statement(id,
+                                      QString("SELECT o.id, u.username, o.total_amount, o.status, o.order_date, o.items_summary "
+                                              "FROM %1 o "
+                                              "JOIN users u ON o.student_id = u.id "
+                                              "WHERE o.shop_id = ? %2%3"
+                                              "ORDER BY o.order_date DESC, o.id DESC "
+                                              "LIMIT ?")
+                                          .arg(includeArchived ? kAllOrders : "orders")
+                                          .arg(status.isEmpty() ? "" : "AND o.status = ? ")
+                                          .arg(after.isNull() ? "" : "AND (o.order_date, o.id) < (?, ?) "));
+    int bind = 0;
+    query->bindValue(bind++, shopId);
+    if (!status.isEmpty()) {
+        query->bindValue(bind++, status);
+    }
+    if (!after.isNull()) {
+        query->bindValue(bind++, after.orderDate);
+        query->bindValue(bind++, after.id);
+    }
+    query->bindValue(bind++, pageSize + 1);
+
+    page.orders.reserve(pageSize);
+    if (query.exec()) {
+        while (query.next()) {
+            if (page.orders.size() == pageSize) {
+                page.hasMore = true;
+                break;
+            }
+            OrderSummary order;
+            order.id = query->value(0).toInt();
+            order.customer = query->value(1).toString();
+            order.totalAmount = query->value(2).toDouble();
+            order.status = query->value(3).toString();
+            order.orderDate = query->value(4).toDateTime();
+            order.items = query->value(5).toString();
+            page.next = {query->value(4).toString(), order.id};
+            page.orders.append(std::move(order));
+        }
+    }
+    timer.setRows(page.orders.size());
+    return page;
+}
+
+int DatabaseManager::archiveCompletedOrders(int olderThanDays, int batchSize) {
+    QueryTimer timer("archiveCompletedOrders");
+    if (orderService) {
+        return orderService->call(Op::ArchiveCompletedOrders, -1, olderThanDays, batchSize);
+    }
+    QSqlDatabase db = database();
+    QSqlQuery query(db);
+    if (!query.exec("CREATE TEMP TABLE IF NOT EXISTS archive_batch (id INTEGER PRIMARY KEY)")) {
+        qDebug() << "Archive batch table error:" << query.lastError().text();
+        return -1;
+    }
+
+    // No delete triggers exist, so shop_stats keeps counting archived revenue
+    const QStringList moves = {
+        "INSERT INTO orders_archive "
+        "(id, student_id, shop_id, total_amount, status, order_date, items_summary, change_seq, updated_at) "
+        "SELECT id, student_id, shop_id, total_amount, status, order_date, items_summary, change_seq, updated_at "
+        "FROM orders WHERE id IN (SELECT id FROM archive_batch)",
+        "INSERT INTO order_items_archive (id, order_id, product_id, quantity, price) "
+        "SELECT id, order_id, product_id, quantity, price "
+        "FROM order_items WHERE order_id IN (SELECT id FROM archive_batch)",
+        "DELETE FROM order_items WHERE order_id IN (SELECT id FROM archive_batch)",
+        "DELETE FROM orders WHERE id IN (SELECT id FROM archive_batch)"
+    };
+
+    int archived = 0;
+    QString cutoff = QString("-%1 days").arg(olderThanDays);
+
+    // One short transaction per batch so order placement is never blocked for long
+    while (true) {
+        if (!beginImmediate(db)) {
+            return archived > 0 ? archived : -1;
+        }
+
+        int moved = 0;
+        bool ok = query.exec("DELETE FROM archive_batch");
+        if (ok) {
+            CachedStatement select = statement("archiveCompletedOrders.select",
+                                               "INSERT INTO archive_batch (id) "
+                                               "SELECT id FROM orders "
+                                               "WHERE status = 'completed' AND order_date < DATETIME('now', ?) "
+                                               "ORDER BY order_date "
+                                               "LIMIT ?");
+            select->bindValue(0, cutoff);
+            select->bindValue(1, batchSize);
+            ok = select.exec();
+            moved = ok ? select->numRowsAffected() : 0;
+        }
+        for (int i = 0; ok && moved > 0 && i < moves.size(); ++i) {
+            CachedStatement move = statement(QString("archiveCompletedOrders.move.%1").arg(i), moves[i]);
+            ok = move.exec();
+            if (!ok) {
+                qDebug() << "Archive orders error:" << move->lastError().text();
+            }
+        }
+
+        if (!ok || !db.commit()) {
+            db.rollback();
+            return archived > 0 ? archived : -1;
+        }
+        archived += moved;
+        if (moved < batchSize) {
+            break;
+        }
+    }
+
+    if (archived > 0) {
+        qDebug() << "Archived" << archived << "completed orders";
+    }
+    timer.setRows(archived);
+    return archived;
+}
+
+void DatabaseManager::startArchiving(int olderThanDays, int intervalMs) {
+    // The order service archives for all of its clients
+    if (orderService) {
+        return;
+    }
+    archiveAfterDays = olderThanDays;
+    if (!archiveTimer) {
+        archiveTimer = new QTimer(this);
+        connect(archiveTimer, &QTimer::timeout, this, &DatabaseManager::runArchivePass);
+    }
+    archiveTimer->start(intervalMs);
+    QTimer::singleShot(0, this, &DatabaseManager::runArchivePass);
+}
+
+void DatabaseManager::runArchivePass() {
+    // Skip a tick while the previous pass is still running
+    if (!archiveRunning.testAndSetAcquire(0, 1)) {
+        return;
+    }
+    int olderThanDays = archiveAfterDays;
+    runAsync([this, olderThanDays]() {
+        archiveCompletedOrders(olderThanDays);
+        archiveRunning.storeRelease(0);
+    });
+}
+
+qint64 DatabaseManager::getOrderChangeSequence() {
+    QueryTimer timer("getOrderChangeSequence");
+    if (orderService) {
+        return orderService->call(Op::GetOrderChangeSequence, qint64(0));
+    }
+    CachedStatement query = statement("getOrderChangeSequence",
+                                      "SELECT value FROM change_sequence WHERE name = 'orders'");
 
     if (query.exec() && query.next()) {
-        return query.value(0).toInt();
+        return query->value(0).toLongLong();
     }
     return 0;
 }
 
-int DatabaseManager::getCompletedOrdersCount(int shopId) {
-    QSqlQuery query;
-    query.prepare("SELECT COUNT(*) FROM orders WHERE shop_id = ? AND status = 'completed'");
-    query.addBindValue(shopId);
+QVector<OrderSummary> DatabaseManager::getOrderChangesSince(int shopId, qint64 sinceSeq, int limit) {
+    QueryTimer timer("getOrderChangesSince");
+    if (orderService) {
+        return orderService->call(Op::GetOrderChangesSince, QVector<OrderSummary>(), shopId, sinceSeq, limit);
+    }
+    QVector<OrderSummary> orders;
+    CachedStatement query = statement("getOrderChangesSince",
+                                      "SELECT o.id, u.username, o.total_amount, o.status, o.order_date, "
+                                      "o.items_summary, o.change_seq "
+                                      "FROM orders o "
+                                      "JOIN users u ON o.student_id = u.id "
+                                      "WHERE o.shop_id = ? AND o.change_seq > ? "
+                                      "ORDER BY o.change_seq "
+                                      "LIMIT ?");
+    query->bindValue(0, shopId);
+    query->bindValue(1, sinceSeq);
+    query->bindValue(2, limit);
+
+    if (query.exec()) {
+        while (query.next()) {
+            OrderSummary order;
+            order.id = query->value(0).toInt();
+            order.customer = query->value(1).toString();
+            order.totalAmount = query->value(2).toDouble();
+            order.status = query->value(3).toString();
+            order.orderDate = query->value(4).toDateTime();
+            order.items = query->value(5).toString();
+            order.changeSeq = query->value(6).toLongLong();
+            orders.append(std::move(order));
+        }
+    }
+    timer.setRows(orders.size());
+    return orders;
+}
+
+ShopStats DatabaseManager::getShopStats(int shopId) {
+    QueryTimer timer("getShopStats");
+    if (orderService) {
+        return orderService->call(Op::GetShopStats, ShopStats(), shopId);
+    }
+    ShopStats stats;
+    CachedStatement query = statement("getShopStats",
+                                      "SELECT s.total_orders, s.completed_orders, s.total_revenue, "
+                                      "COALESCE((SELECT d.revenue FROM shop_daily_stats d "
+                                      "WHERE d.shop_id = s.shop_id AND d.day = DATE('now')), 0) "
+                                      "FROM shop_stats s WHERE s.shop_id = ?");
+    query->bindValue(0, shopId);
 
     if (query.exec() && query.next()) {
-        return query.value(0).toInt();
+        stats.totalOrders = query->value(0).toInt();
+        stats.completedOrders = query->value(1).toInt();
+        stats.totalRevenue = query->value(2).toDouble();
+        stats.todayRevenue = query->value(3).toDouble();
     }
-    return 0;
+
+    // Only active orders are counted live; they are a small slice of the shop's history
+    CachedStatement active = statement("getShopStats.active",
+                                       "SELECT status, COUNT(*) FROM orders "
+                                       "WHERE shop_id = ? AND status IN ('pending', 'preparing') "
+                                       "GROUP BY status");
+    active->bindValue(0, shopId);
+
+    if (active.exec()) {
+        while (active.next()) {
+            if (active->value(0).toString() == "pending") {
+                stats.pendingOrders = active->value(1).toInt();
+            } else {
+                stats.preparingOrders = active->value(1).toInt();
+            }
+        }
+    }
+    return stats;
+}
+
+double DatabaseManager::getTotalRevenue(int shopId) {
+    return getShopStats(shopId).totalRevenue;
+}
+
+double DatabaseManager::getTodayRevenue(int shopId) {
+    return getShopStats(shopId).todayRevenue;
+}
+
+int DatabaseManager::getTotalOrdersCount(int shopId) {
+    return getShopStats(shopId).totalOrders;
+}
+
+int DatabaseManager::getCompletedOrdersCount(int shopId) {
+    return getShopStats(shopId).completedOrders;
+}
+
+CachedStatement DatabaseManager::statement(const QString &id, const QString &sql) {
+    StatementCache &cache = threadConnection().statements;
+    return CachedStatement(cache.prepare(id, sql), &cache);
+}
+
+CatalogSnapshot DatabaseManager::catalog() {
+    QueryTimer timer("catalog");
+    // Held across the rebuild so concurrent windows wait for one query instead of each running it
+    QMutexLocker locker(&catalogMutex);
+    quint64 version = catalogVersion();
+    if (cachedCatalog.version != version) {
+        if (orderService) {
+            // One round trip for the version, and one for the menu only when it changed
+            cachedCatalog = orderService->call(Op::GetCatalog, CatalogSnapshot());
+        } else {
+            // A write racing with this read only bumps the version again, forcing another rebuild
+            cachedCatalog.products = getAllAvailableProducts();
+            cachedCatalog.version = version;
+        }
+    }
+    return cachedCatalog;
+}
+
+quint64 DatabaseManager::catalogVersion() const {
+    if (orderService) {
+        return orderService->call(Op::GetCatalogVersion, quint64(0));
+    }
+    return catalogVersionCounter.loadAcquire();
+}
+
+void DatabaseManager::invalidateCatalog() {
+    catalogVersionCounter.fetchAndAddRelease(1);
+}
+
+qint64 DatabaseManager::statementCacheHits() const {
+    return statementCounters.hits.load(std::memory_order_relaxed);
+}
+
+qint64 DatabaseManager::statementCacheMisses() const {
+    return statementCounters.misses.load(std::memory_order_relaxed);
+}
+
+qint64 DatabaseManager::busyErrors() const {
+    return statementCounters.busy.load(std::memory_order_relaxed);
 }
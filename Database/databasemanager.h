@@ -7,7 +7,119 @@
 #include <QSqlError>
 #include <QVariant>
 #include <QDebug>
-#include <QMessageBox>
+#include <QDateTime>
+#include <QThreadStorage>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QFuture>
+#include <QPromise>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <memory>
+#include "statementcache.h"
+#include "slowquerylog.h"
+
+struct Product {
+    int id = -1;
+    int shopId = -1;
+    QString name;
+    QString shopName;
+    double price = 0.0;
+    QString category;
+    bool available = true;
+};
+
+// Menu of available products at one catalog version; copies share the product array
+struct CatalogSnapshot {
+    QVector<Product> products;
+    quint64 version = 0;
+};
+
+struct OrderSummary {
+    int id = -1;
+    QString shopName;   // set for student views
+    QString customer;   // set for vendor views
+    double totalAmount = 0.0;
+    QString status;
+    QDateTime orderDate;
+    QString items;      // "Chicken Biryani x 2,Coke x 1", vendor views only
+    qint64 changeSeq = 0;  // set by getOrderChangesSince
+};
+
+struct OrderItem {
+    QString productName;
+    int quantity = 0;
+    double price = 0.0;
+};
+
+struct ShopStats {
+    double totalRevenue = 0.0;
+    double todayRevenue = 0.0;
+    int totalOrders = 0;
+    int completedOrders = 0;
+    int pendingOrders = 0;
+    int preparingOrders = 0;
+};
+
+// Keyset position in an (order_date, id) DESC listing; a null cursor starts at the newest order
+struct OrderCursor {
+    QString orderDate;  // raw stored text, compared exactly as SQLite sorts it
+    int id = 0;
+
+    bool isNull() const { return orderDate.isEmpty(); }
+};
+
+struct OrderPage {
+    QVector<OrderSummary> orders;
+    OrderCursor next;
+    bool hasMore = false;
+};
+
+// A saved cart line with the product as it is now; price and availability may have changed
+struct SavedCartItem {
+    Product product;
+    int quantity = 0;
+};
+
+Q_DECLARE_TYPEINFO(Product, Q_RELOCATABLE_TYPE);
+Q_DECLARE_TYPEINFO(SavedCartItem, Q_RELOCATABLE_TYPE);
+Q_DECLARE_TYPEINFO(OrderSummary, Q_RELOCATABLE_TYPE);
+Q_DECLARE_TYPEINFO(OrderItem, Q_RELOCATABLE_TYPE);
+
+struct OrderLine {
+    int productId;
+    int shopId;
+    int quantity;
+    double price;
+};
+
+struct ImportError {
+    int line;
+    QString message;
+};
+
+struct ProductImportResult {
+    int imported = 0;
+    int rejected = 0;
+    QVector<ImportError> errors;  // first 100 only; rejected has the full count
+    bool canceled = false;
+    bool failed = false;          // file unreadable or a batch failed to commit
+};
+
+enum class ExportFormat {
+    Csv,
+    JsonLines
+};
+
+struct OrderExportResult {
+    qint64 rows = 0;
+    bool failed = false;
+    QString error;
+};
+
+class QTimer;
+class OrderServiceClient;
+class QLocalSocket;
 
 class DatabaseManager : public QObject
 {
@@ -19,7 +131,39 @@ public:
         return instance;
     }
 
-    bool initializeDatabase();
+    // Calling it again with another file moves every thread to that file on its next call;
+    // nothing may still be running against the old one
+    bool initializeDatabase(const QString &path = "ceg_square.db");
+    // Use instead of initializeDatabase on kiosks: every call below then goes to the order
+    // service (see Order Service/) rather than opening the database file in this process
+    bool connectToOrderService(const QString &serverName);
+    bool usesOrderService() const { return orderService != nullptr; }
+
+    // Connection for the calling thread, opened on first use and closed when the thread exits
+    QSqlDatabase database();
+    void setBusyTimeout(int milliseconds);
+
+    // Statements slower than this are written once each to the slow query log with their
+    // plan; negative disables. Defaults to CEG_SLOW_QUERY_MS, or disabled when that is unset.
+    void setSlowQueryThreshold(int milliseconds);
+    int slowQueryThreshold() const;
+    // Defaults to slow_queries.log next to the database file; rotated at 1 MB, three old files kept
+    void setSlowQueryLogPath(const QString &path);
+
+    // Asynchronous API: work runs on the database worker pool. Chain .then(context, ...) to get
+    // the result on the context's thread; destroying the context cancels delivery.
+    template <typename Func>
+    auto runAsync(Func &&call) {
+        return QtConcurrent::run(&workerPool, std::forward<Func>(call));
+    }
+
+    // Async variant of any DatabaseManager call, e.g. async(&DatabaseManager::getOrdersByShop, shopId)
+    template <typename Ret, typename... Params, typename... Args>
+    QFuture<Ret> async(Ret (DatabaseManager::*method)(Params...), Args... args) {
+        return QtConcurrent::run(&workerPool, [this, method, args...]() {
+            return (this->*method)(args...);
+        });
+    }
 
     // User management
     bool registerUser(const QString &username, const QString &password,
@@ -39,26 +183,126 @@ public:
     // Product management
     bool addProduct(int shopId, const QString &name, double price, const QString &category);
     bool updateProductAvailability(int productId, bool available);
-    QVector<QVector<QVariant>> getProductsByShop(int shopId);
-    QVector<QVector<QVariant>> getAllAvailableProducts();
+    QVector<Product> getProductsByShop(int shopId);
+    QVector<Product> getAllAvailableProducts();
+    // Ranked prefix search over available products by name, category and shop name
+    QVector<Product> searchProducts(const QString &text, int limit = 200);
+
+    // Bulk CSV import of "name,price,category[,available]" rows; a first row starting "name,price" is
+    // skipped as a header. Rows are validated one by one and inserted in batched transactions; progress
+    // runs 0-1000 over the file. Canceling keeps the batches already committed. A canceled future drops
+    // its result, so the result is also copied to summary, when given, before the future finishes.
+    QFuture<ProductImportResult> importProductsAsync(int shopId, const QString &filePath,
+                                                     std::shared_ptr<ProductImportResult> summary = nullptr);
+    void importProducts(QPromise<ProductImportResult> &promise, int shopId, const QString &filePath,
+                        ProductImportResult *summary = nullptr);
+
+    // Streams one shop's orders for a calendar month, archived ones included, to filePath. Rows are read
+    // forward-only and written through a fixed-size buffer, so memory does not grow with the row count.
+    // Progress runs over the row count; a canceled or failed export leaves no file behind.
+    QFuture<OrderExportResult> exportOrdersAsync(int shopId, const QDate &month, ExportFormat format,
+                                                 const QString &filePath);
+    void exportOrders(QPromise<OrderExportResult> &promise, int shopId, const QDate &month,
+                      ExportFormat format, const QString &filePath);
 
     // Order management
+    int placeOrder(int studentId, const QVector<OrderLine> &cart);
     int createOrder(int studentId, int shopId, double totalAmount);
     bool addOrderItem(int orderId, int productId, int quantity, double price);
     bool updateOrderStatus(int orderId, const QString &status);
-    QVector<QVector<QVariant>> getOrdersByStudent(int studentId);
-    QVector<QVector<QVariant>> getOrdersByShop(int shopId);
-    QVector<QVector<QVariant>> getOrderItems(int orderId);
+    QVector<OrderSummary> getOrdersByStudent(int studentId);
+    QVector<OrderSummary> getOrdersByShop(int shopId);
+    // includeArchived also reads order_items_archive, for orders from the archived history
+    QVector<OrderItem> getOrderItems(int orderId, bool includeArchived = false);
+
+    // Per-student cart kept across logouts and crashes. A quantity of 0 or less removes the
+    // product; placeOrder empties the cart in the same transaction as the order. Only products
+    // still available come back from getSavedCart, in the order they were first added.
+    bool saveCartItem(int studentId, int productId, int quantity);
+    bool clearSavedCart(int studentId);
+    QVector<SavedCartItem> getSavedCart(int studentId);
 
-    // Financial queries
+    // Paged order history; cost is bounded by pageSize however long the history is
+    // includeArchived also pages through orders_archive, merged in the same order
+    OrderPage getOrdersByStudentPage(int studentId, const OrderCursor &after, int pageSize,
+                                     bool includeArchived = false);
+    OrderPage getOrdersByShopPage(int shopId, const OrderCursor &after, int pageSize,
+                                  const QString &status = QString(), bool includeArchived = false);
+
+    // Moves completed orders older than the cutoff, and their items, to the archive tables in batches.
+    // Returns the number of orders moved, or -1 if the first batch failed.
+    int archiveCompletedOrders(int olderThanDays, int batchSize = 500);
+    // Runs archiveCompletedOrders on the worker pool now and then every intervalMs
+    void startArchiving(int olderThanDays, int intervalMs);
+
+    // Incremental change feed: orders inserted or changed after sinceSeq, oldest change first
+    qint64 getOrderChangeSequence();
+    QVector<OrderSummary> getOrderChangesSince(int shopId, qint64 sinceSeq, int limit = 500);
+
+    // Financial queries (read from trigger-maintained shop_stats, O(1) per shop)
+    ShopStats getShopStats(int shopId);
     double getTotalRevenue(int shopId);
     double getTodayRevenue(int shopId);
     int getTotalOrdersCount(int shopId);
     int getCompletedOrdersCount(int shopId);
 
+    // Shared menu catalog, rebuilt only after addProduct, updateProductAvailability or registerShop
+    CatalogSnapshot catalog();
+    quint64 catalogVersion() const;
+
+    // Prepared statement cache statistics (all connections)
+    qint64 statementCacheHits() const;
+    qint64 statementCacheMisses() const;
+    // Statements that failed with SQLITE_BUSY/SQLITE_LOCKED after the busy timeout
+    qint64 busyErrors() const;
+
+signals:
+    // Emitted once updateOrderStatus has committed, on the thread that ran it. Through the
+    // order service, kiosks also receive changes made on every other kiosk.
+    void orderStatusChanged(int orderId, const QString &status);
+
 private:
-    DatabaseManager() {}
-    ~DatabaseManager() {}
+    struct ThreadConnection;
+
+    ThreadConnection &threadConnection();
+    bool openConnection(const QString &name);
+    bool beginImmediate(QSqlDatabase &db);
+
+    // Schema migrations (PRAGMA user_version)
+    int schemaVersion();
+    bool createBaseSchema();
+    bool runMigrations(int current);
+
+    // Returns the prepared statement for id, preparing sql only on first use
+    CachedStatement statement(const QString &id, const QString &sql);
+
+    void invalidateCatalog();
+    void runArchivePass();
+    void subscribeToOrderEvents();
+    void readOrderEvents();
+    void dropOrderEvents();
+
+    QString databasePath;
+    int busyTimeout = 5000;
+    QAtomicInt connectionSerial;
+    QAtomicInt databaseGeneration;  // bumped when initializeDatabase switches files
+    QThreadPool workerPool;
+    StatementCache::Counters statementCounters;
+    SlowQueryLog slowQueries;  // outlives the per-thread statement caches that point to it
+    QThreadStorage<ThreadConnection*> connections;
+    QAtomicInteger<quint64> catalogVersionCounter{1};
+    QMutex catalogMutex;
+    CatalogSnapshot cachedCatalog;  // version 0 until first built
+    QTimer *archiveTimer = nullptr;
+    int archiveAfterDays = 0;
+    QAtomicInt archiveRunning;
+    OrderServiceClient *orderService = nullptr;
+    QLocalSocket *orderEvents = nullptr;
+    bool orderEventsSubscribed = false;  // handshake reply read; later frames are events
+    QByteArray orderEventBuffer;
+
+    DatabaseManager();
+    ~DatabaseManager();
     DatabaseManager(const DatabaseManager&) = delete;
     DatabaseManager& operator=(const DatabaseManager&) = delete;
 };
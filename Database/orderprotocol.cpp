@@ -0,0 +1,153 @@
+#include "orderprotocol.h"
+#include <QtEndian>
+
+namespace OrderProtocol {
+
+bool isWrite(Op op) {
+    switch (op) {
+    case Op::RegisterUser:
+    case Op::RegisterShop:
+    case Op::AddProduct:
+    case Op::UpdateProductAvailability:
+    case Op::ImportProducts:
+    case Op::PlaceOrder:
+    case Op::CreateOrder:
+    case Op::AddOrderItem:
+    case Op::UpdateOrderStatus:
+    case Op::ArchiveCompletedOrders:
+    case Op::SaveCartItem:
+    case Op::ClearSavedCart:
+        return true;
+    default:
+        return false;
+    }
+}
+
+QByteArray frame(const QByteArray &payload) {
+    QByteArray data(4, Qt::Uninitialized);
+    qToBigEndian<quint32>(quint32(payload.size()), data.data());
+    data += payload;
+    return data;
+}
+
+bool takeFrame(QByteArray &buffer, QByteArray &payload, bool &corrupt) {
+    corrupt = false;
+    if (buffer.size() < 4) {
+        return false;
+    }
+    quint32 length = qFromBigEndian<quint32>(buffer.constData());
+    if (length > kMaxFrameBytes) {
+        corrupt = true;
+        return false;
+    }
+    if (quint32(buffer.size()) - 4 < length) {
+        return false;
+    }
+    payload = buffer.mid(4, length);
+    buffer.remove(0, 4 + length);
+    return true;
+}
+
+}
+
+QDataStream &operator<<(QDataStream &out, const Product &product) {
+    return out << product.id << product.shopId << product.name << product.shopName << product.price
+               << product.category << product.available;
+}
+
+QDataStream &operator>>(QDataStream &in, Product &product) {
+    return in >> product.id >> product.shopId >> product.name >> product.shopName >> product.price
+              >> product.category >> product.available;
+}
+
+QDataStream &operator<<(QDataStream &out, const CatalogSnapshot &catalog) {
+    return out << catalog.products << catalog.version;
+}
+
+QDataStream &operator>>(QDataStream &in, CatalogSnapshot &catalog) {
+    return in >> catalog.products >> catalog.version;
+}
+
+QDataStream &operator<<(QDataStream &out, const OrderSummary &order) {
+    return out << order.id << order.shopName << order.customer << order.totalAmount << order.status
+               << order.orderDate << order.items << order.changeSeq;
+}
+
+QDataStream &operator>>(QDataStream &in, OrderSummary &order) {
+    return in >> order.id >> order.shopName >> order.customer >> order.totalAmount >> order.status
+              >> order.orderDate >> order.items >> order.changeSeq;
+}
+
+QDataStream &operator<<(QDataStream &out, const OrderItem &item) {
+    return out << item.productName << item.quantity << item.price;
+}
+
+QDataStream &operator>>(QDataStream &in, OrderItem &item) {
+    return in >> item.productName >> item.quantity >> item.price;
+}
+
+QDataStream &operator<<(QDataStream &out, const ShopStats &stats) {
+    return out << stats.totalRevenue << stats.todayRevenue << stats.totalOrders << stats.completedOrders
+               << stats.pendingOrders << stats.preparingOrders;
+}
+
+QDataStream &operator>>(QDataStream &in, ShopStats &stats) {
+    return in >> stats.totalRevenue >> stats.todayRevenue >> stats.totalOrders >> stats.completedOrders
+              >> stats.pendingOrders >> stats.preparingOrders;
+}
+
+QDataStream &operator<<(QDataStream &out, const OrderCursor &cursor) {
+    return out << cursor.orderDate << cursor.id;
+}
+
+QDataStream &operator>>(QDataStream &in, OrderCursor &cursor) {
+    return in >> cursor.orderDate >> cursor.id;
+}
+
+QDataStream &operator<<(QDataStream &out, const OrderPage &page) {
+    return out << page.orders << page.next << page.hasMore;
+}
+
+QDataStream &operator>>(QDataStream &in, OrderPage &page) {
+    return in >> page.orders >> page.next >> page.hasMore;
+}
+
+QDataStream &operator<<(QDataStream &out, const SavedCartItem &item) {
+    return out << item.product << item.quantity;
+}
+
+QDataStream &operator>>(QDataStream &in, SavedCartItem &item) {
+    return in >> item.product >> item.quantity;
+}
+
+QDataStream &operator<<(QDataStream &out, const OrderLine &line) {
+    return out << line.productId << line.shopId << line.quantity << line.price;
+}
+
+QDataStream &operator>>(QDataStream &in, OrderLine &line) {
+    return in >> line.productId >> line.shopId >> line.quantity >> line.price;
+}
+
+QDataStream &operator<<(QDataStream &out, const ImportError &error) {
+    return out << error.line << error.message;
+}
+
+QDataStream &operator>>(QDataStream &in, ImportError &error) {
+    return in >> error.line >> error.message;
+}
+
+QDataStream &operator<<(QDataStream &out, const ProductImportResult &result) {
+    return out << result.imported << result.rejected << result.errors << result.canceled << result.failed;
+}
+
+QDataStream &operator>>(QDataStream &in, ProductImportResult &result) {
+    return in >> result.imported >> result.rejected >> result.errors >> result.canceled >> result.failed;
+}
+
+QDataStream &operator<<(QDataStream &out, const OrderExportResult &result) {
+    return out << result.rows << result.failed << result.error;
+}
+
+QDataStream &operator>>(QDataStream &in, OrderExportResult &result) {
+    return in >> result.rows >> result.failed >> result.error;
+}
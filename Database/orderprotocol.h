@@ -0,0 +1,106 @@
+#ifndef ORDERPROTOCOL_H
+#define ORDERPROTOCOL_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include "databasemanager.h"
+
+// Wire format between the order service and its kiosk clients. Every message is a
+// quint32 payload length followed by a QDataStream payload. A request is a quint16 Op and
+// the call's arguments in declaration order; a reply is a quint8 Status and, on Ok, the
+// return value. A connection has at most one request in flight.
+//
+// A connection that sends Subscribe gets no reply; from then on the service pushes event
+// messages shaped like requests (an event Op and its arguments) and it sends nothing else.
+namespace OrderProtocol {
+
+const quint32 kVersion = 4;
+const char *const kDefaultServerName = "ceg_square_orders";
+const quint32 kMaxFrameBytes = 64 * 1024 * 1024;
+const QDataStream::Version kStreamVersion = QDataStream::Qt_6_0;
+
+// Append only; values are on the wire
+enum class Op : quint16 {
+    Hello = 1,
+    RegisterUser,
+    ValidateLogin,
+    GetUserId,
+    UsernameExists,
+    GetUsername,
+    RegisterShop,
+    GetShopId,
+    GetShopName,
+    GetAllShops,
+    AddProduct,
+    UpdateProductAvailability,
+    GetProductsByShop,
+    GetAllAvailableProducts,
+    SearchProducts,
+    ImportProducts,
+    ExportOrders,
+    PlaceOrder,
+    CreateOrder,
+    AddOrderItem,
+    UpdateOrderStatus,
+    GetOrdersByStudent,
+    GetOrdersByShop,
+    GetOrderItems,
+    GetOrdersByStudentPage,
+    GetOrdersByShopPage,
+    ArchiveCompletedOrders,
+    GetOrderChangeSequence,
+    GetOrderChangesSince,
+    GetShopStats,
+    GetCatalog,
+    GetCatalogVersion,
+    Subscribe,
+    // Events
+    OrderStatusChanged,
+    // Saved carts
+    SaveCartItem,
+    ClearSavedCart,
+    GetSavedCart
+};
+
+enum class Status : quint8 {
+    Ok = 0,
+    UnknownOp,
+    BadRequest
+};
+
+// Calls that write; the service runs them one at a time on a single connection
+bool isWrite(Op op);
+
+QByteArray frame(const QByteArray &payload);
+// Moves the first complete frame's payload out of buffer; false if none is complete yet.
+// An oversized length marks the stream as corrupt.
+bool takeFrame(QByteArray &buffer, QByteArray &payload, bool &corrupt);
+
+}
+
+QDataStream &operator<<(QDataStream &out, const Product &product);
+QDataStream &operator>>(QDataStream &in, Product &product);
+QDataStream &operator<<(QDataStream &out, const CatalogSnapshot &catalog);
+QDataStream &operator>>(QDataStream &in, CatalogSnapshot &catalog);
+QDataStream &operator<<(QDataStream &out, const OrderSummary &order);
+QDataStream &operator>>(QDataStream &in, OrderSummary &order);
+QDataStream &operator<<(QDataStream &out, const OrderItem &item);
+QDataStream &operator>>(QDataStream &in, OrderItem &item);
+QDataStream &operator<<(QDataStream &out, const ShopStats &stats);
+QDataStream &operator>>(QDataStream &in, ShopStats &stats);
+QDataStream &operator<<(QDataStream &out, const OrderCursor &cursor);
+QDataStream &operator>>(QDataStream &in, OrderCursor &cursor);
+QDataStream &operator<<(QDataStream &out, const OrderPage &page);
+QDataStream &operator>>(QDataStream &in, OrderPage &page);
+QDataStream &operator<<(QDataStream &out, const SavedCartItem &item);
+QDataStream &operator>>(QDataStream &in, SavedCartItem &item);
+QDataStream &operator<<(QDataStream &out, const OrderLine &line);
+QDataStream &operator>>(QDataStream &in, OrderLine &line);
+QDataStream &operator<<(QDataStream &out, const ImportError &error);
+QDataStream &operator>>(QDataStream &in, ImportError &error);
+QDataStream &operator<<(QDataStream &out, const ProductImportResult &result);
+QDataStream &operator>>(QDataStream &in, ProductImportResult &result);
+QDataStream &operator<<(QDataStream &out, const OrderExportResult &result);
+QDataStream &operator>>(QDataStream &in, OrderExportResult &result);
+
+#endif
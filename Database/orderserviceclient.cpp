@@ -0,0 +1,123 @@
+#include "orderserviceclient.h"
+#include <QLocalSocket>
+
+namespace {
+
+const int kConnectTimeoutMs = 3000;
+// Generous so a large import or export on the service is not cut off
+const int kRequestTimeoutMs = 120000;
+
+bool readFrame(QLocalSocket *socket, QByteArray &payload, int timeoutMs) {
+    QByteArray buffer;
+    bool corrupt = false;
+    for (;;) {
+        buffer += socket->readAll();
+        if (OrderProtocol::takeFrame(buffer, payload, corrupt)) {
+            return true;
+        }
+        if (corrupt || !socket->waitForReadyRead(timeoutMs)) {
+            return false;
+        }
+    }
+}
+
+QByteArray requestFrame(OrderProtocol::Op op) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(OrderProtocol::kStreamVersion);
+    out << quint16(op);
+    if (op == OrderProtocol::Op::Hello) {
+        out << OrderProtocol::kVersion;
+    }
+    return OrderProtocol::frame(payload);
+}
+
+}
+
+OrderServiceClient::OrderServiceClient(const QString &serverName) :
+    serverName(serverName)
+{
+}
+
+bool OrderServiceClient::connectToService() {
+    return threadSocket() != nullptr;
+}
+
+QLocalSocket *OrderServiceClient::subscribe(QObject *parent) {
+    QLocalSocket *socket = new QLocalSocket(parent);
+    // The service answers Hello before it reads Subscribe, so both can go at once
+    QObject::connect(socket, &QLocalSocket::connected, socket, [socket]() {
+        socket->write(requestFrame(OrderProtocol::Op::Hello) + requestFrame(OrderProtocol::Op::Subscribe));
+    });
+    socket->connectToServer(serverName);
+    return socket;
+}
+
+bool OrderServiceClient::acceptsHandshake(const QByteArray &reply) const {
+    QDataStream in(reply);
+    in.setVersion(OrderProtocol::kStreamVersion);
+    quint8 status = 0;
+    quint32 version = 0;
+    in >> status >> version;
+    if (status != quint8(OrderProtocol::Status::Ok) || version != OrderProtocol::kVersion) {
+        qDebug() << "Order service" << serverName << "speaks protocol" << version
+                 << "but this build needs" << OrderProtocol::kVersion;
+        return false;
+    }
+    return true;
+}
+
+QLocalSocket *OrderServiceClient::threadSocket() {
+    QLocalSocket *socket = sockets.hasLocalData() ? sockets.localData() : nullptr;
+    if (socket && socket->state() == QLocalSocket::ConnectedState) {
+        return socket;
+    }
+    // Replaces (and deletes) a socket the service closed, e.g. after a service restart
+    sockets.setLocalData(openSocket());
+    return sockets.localData();
+}
+
+QLocalSocket *OrderServiceClient::openSocket() {
+    QLocalSocket *socket = new QLocalSocket;
+    socket->connectToServer(serverName);
+    if (!socket->waitForConnected(kConnectTimeoutMs)) {
+        qDebug() << "Cannot reach order service" << serverName << ":" << socket->errorString();
+        delete socket;
+        return nullptr;
+    }
+
+    socket->write(requestFrame(OrderProtocol::Op::Hello));
+    socket->waitForBytesWritten(kConnectTimeoutMs);
+
+    QByteArray reply;
+    if (!readFrame(socket, reply, kConnectTimeoutMs)) {
+        qDebug() << "Order service" << serverName << "did not answer the handshake";
+        delete socket;
+        return nullptr;
+    }
+
+    if (!acceptsHandshake(reply)) {
+        delete socket;
+        return nullptr;
+    }
+    return socket;
+}
+
+bool OrderServiceClient::roundTrip(const QByteArray &request, QByteArray &reply) {
+    // Reconnecting is only safe before the request is sent; a write must never be sent twice
+    QLocalSocket *socket = threadSocket();
+    if (!socket) {
+        return false;
+    }
+
+    socket->write(OrderProtocol::frame(request));
+    socket->waitForBytesWritten(kRequestTimeoutMs);
+
+    if (!readFrame(socket, reply, kRequestTimeoutMs)) {
+        qDebug() << "Order service request failed:" << socket->errorString();
+        // A late reply would otherwise be read as the answer to the next request
+        socket->abort();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef ORDERSERVICECLIENT_H
+#define ORDERSERVICECLIENT_H
+
+#include <QString>
+#include <QThreadStorage>
+#include <QDebug>
+#include "orderprotocol.h"
+
+class QLocalSocket;
+
+// Blocking client for the order service. Each thread gets its own socket, the same way
+// DatabaseManager gives each thread its own SQLite connection, so calls from the worker
+// pool never wait on each other here.
+class OrderServiceClient
+{
+public:
+    explicit OrderServiceClient(const QString &serverName);
+
+    // Connects the calling thread and checks the protocol version
+    bool connectToService();
+    // A separate socket that receives pushed events, owned by parent. It connects without
+    // blocking and sends the handshake and Subscribe once connected; the first frame read
+    // back is the handshake reply (see acceptsHandshake), every later one is an event.
+    QLocalSocket *subscribe(QObject *parent);
+    bool acceptsHandshake(const QByteArray &reply) const;
+
+    // Sends op with args and returns the reply, or failed if the service is unreachable or
+    // rejects the request. Args must have the exact types the DatabaseManager call takes.
+    template <typename Ret, typename... Args>
+    Ret call(OrderProtocol::Op op, Ret failed, const Args &...args) {
+        QByteArray request;
+        {
+            QDataStream out(&request, QIODevice::WriteOnly);
+            out.setVersion(OrderProtocol::kStreamVersion);
+            out << quint16(op);
+            (out << ... << args);
+        }
+
+        QByteArray reply;
+        if (!roundTrip(request, reply)) {
+            return failed;
+        }
+        QDataStream in(reply);
+        in.setVersion(OrderProtocol::kStreamVersion);
+        quint8 status = 0;
+        Ret result{};
+        in >> status;
+        if (status != quint8(OrderProtocol::Status::Ok)) {
+            qDebug() << "Order service rejected request" << quint16(op) << "with status" << status;
+            return failed;
+        }
+        in >> result;
+        return in.status() == QDataStream::Ok ? result : failed;
+    }
+
+private:
+    QLocalSocket *threadSocket();
+    QLocalSocket *openSocket();
+    bool roundTrip(const QByteArray &request, QByteArray &reply);
+
+    QString serverName;
+    QThreadStorage<QLocalSocket*> sockets;
+};
+
+#endif
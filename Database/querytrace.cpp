@@ -0,0 +1,197 @@
+#include "querytrace.h"
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QHash>
+#include <QVector>
+#include <QFile>
+#include <QThread>
+#include <QStringList>
+#include <QDebug>
+#include <QtAlgorithms>
+#include <array>
+#include <algorithm>
+
+std::atomic<bool> QueryTrace::active{false};
+
+namespace {
+
+const int kSubBuckets = 16;
+const int kBuckets = 61 * kSubBuckets;
+const int kMaxEvents = 1000000;
+
+// HDR-style log-linear buckets: 16 linear steps per power of two, about 6% relative error
+int bucketFor(qint64 ns) {
+    if (ns < kSubBuckets) {
+        return int(qMax<qint64>(0, ns));
+    }
+    int exponent = 63 - int(qCountLeadingZeroBits(quint64(ns)));
+    int sub = int((ns >> (exponent - 4)) & (kSubBuckets - 1));
+    return qMin(kBuckets - 1, (exponent - 3) * kSubBuckets + sub);
+}
+
+qint64 bucketMidpoint(int index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    int exponent = index / kSubBuckets + 3;
+    qint64 lower = qint64(kSubBuckets + index % kSubBuckets) << (exponent - 4);
+    return lower + (qint64(1) << (exponent - 4)) / 2;
+}
+
+struct Histogram {
+    std::array<qint64, kBuckets> counts{};
+    qint64 count = 0;
+    qint64 maxNs = 0;
+    qint64 rowCalls = 0;
+    qint64 rows = 0;
+
+    qint64 percentile(double fraction) const {
+        qint64 target = qMax<qint64>(1, qint64(count * fraction + 0.5));
+        qint64 seen = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= target) {
+                return qMin(bucketMidpoint(i), maxNs);
+            }
+        }
+        return maxNs;
+    }
+};
+
+struct Event {
+    const char *operation;
+    quintptr thread;
+    qint64 startNs;
+    qint64 durationNs;
+    qint64 rows;
+};
+
+QElapsedTimer &clock() {
+    static QElapsedTimer timer;
+    return timer;
+}
+
+QMutex mutex;
+QHash<QByteArray, Histogram> histograms;
+QVector<Event> events;
+qint64 droppedEvents = 0;
+QString tracePath = "ceg_square_trace.json";
+
+}
+
+void QueryTrace::setEnabled(bool on) {
+    if (on && !clock().isValid()) {
+        clock().start();
+    }
+    active.store(on, std::memory_order_relaxed);
+}
+
+void QueryTrace::configureFromEnvironment() {
+    QString value = qEnvironmentVariable("CEG_QUERY_TRACE");
+    if (value.isEmpty() || value == "0") {
+        return;
+    }
+    if (value != "1") {
+        tracePath = value;
+    }
+    setEnabled(true);
+}
+
+qint64 QueryTrace::now() {
+    return clock().nsecsElapsed();
+}
+
+void QueryTrace::record(const char *operation, qint64 startNs, qint64 endNs, qint64 rows) {
+    qint64 duration = endNs - startNs;
+    quintptr thread = quintptr(QThread::currentThreadId());
+
+    QMutexLocker locker(&mutex);
+    Histogram &histogram = histograms[QByteArray::fromRawData(operation, int(qstrlen(operation)))];
+    ++histogram.counts[bucketFor(duration)];
+    ++histogram.count;
+    histogram.maxNs = qMax(histogram.maxNs, duration);
+    if (rows >= 0) {
+        ++histogram.rowCalls;
+        histogram.rows += rows;
+    }
+
+    if (events.size() < kMaxEvents) {
+        events.append({operation, thread, startNs, duration, rows});
+    } else {
+        ++droppedEvents;
+    }
+}
+
+QString QueryTrace::summary() {
+    QMutexLocker locker(&mutex);
+    QStringList operations;
+    for (auto it = histograms.cbegin(); it != histograms.cend(); ++it) {
+        operations.append(QString::fromLatin1(it.key()));
+    }
+    operations.sort();
+
+    QString table = QString("%1 %2 %3 %4 %5 %6 %7\n")
+                        .arg("operation", -32).arg("calls", 8).arg("p50 us", 10).arg("p90 us", 10)
+                        .arg("p99 us", 10).arg("max us", 10).arg("rows", 8);
+    for (const QString &operation : operations) {
+        const Histogram &h = histograms[operation.toLatin1()];
+        table += QString("%1 %2 %3 %4 %5 %6 %7\n")
+                     .arg(operation, -32)
+                     .arg(h.count, 8)
+                     .arg(h.percentile(0.50) / 1e3, 10, 'f', 1)
+                     .arg(h.percentile(0.90) / 1e3, 10, 'f', 1)
+                     .arg(h.percentile(0.99) / 1e3, 10, 'f', 1)
+                     .arg(h.maxNs / 1e3, 10, 'f', 1)
+                     .arg(h.rowCalls > 0 ? QString::number(double(h.rows) / h.rowCalls, 'f', 1) : QString("-"), 8);
+    }
+    if (droppedEvents > 0) {
+        table += QString("%1 trace events dropped after the first %2\n").arg(droppedEvents).arg(kMaxEvents);
+    }
+    return table;
+}
+
+bool QueryTrace::writeChromeTrace(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Cannot write query trace" << path << ":" << file.errorString();
+        return false;
+    }
+
+    QMutexLocker locker(&mutex);
+    // Small stable thread ids read better in the viewer than native handles
+    QHash<quintptr, int> threadIds;
+    QByteArray chunk = "{\"traceEvents\":[\n";
+    for (int i = 0; i < events.size(); ++i) {
+        const Event &e = events[i];
+        int tid = threadIds.value(e.thread, -1);
+        if (tid == -1) {
+            tid = threadIds.size() + 1;
+            threadIds.insert(e.thread, tid);
+        }
+        chunk += QString("{\"name\":\"%1\",\"cat\":\"db\",\"ph\":\"X\",\"pid\":1,\"tid\":%2,"
+                         "\"ts\":%3,\"dur\":%4,\"args\":{\"rows\":%5}}%6\n")
+                     .arg(QString::fromLatin1(e.operation))
+                     .arg(tid)
+                     .arg(e.startNs / 1e3, 0, 'f', 3)
+                     .arg(e.durationNs / 1e3, 0, 'f', 3)
+                     .arg(e.rows)
+                     .arg(i + 1 < events.size() ? "," : "")
+                     .toUtf8();
+        if (chunk.size() > 64 * 1024) {
+            file.write(chunk);
+            chunk.clear();
+        }
+    }
+    chunk += "]}\n";
+    return file.write(chunk) == chunk.size();
+}
+
+void QueryTrace::dump() {
+    if (!enabled()) {
+        return;
+    }
+    qDebug().noquote() << "Database query summary:\n" + summary();
+    if (writeChromeTrace(tracePath)) {
+        qDebug() << "Query trace written to" << tracePath;
+    }
+}
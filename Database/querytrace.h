@@ -0,0 +1,55 @@
+#ifndef QUERYTRACE_H
+#define QUERYTRACE_H
+
+#include <QString>
+#include <atomic>
+
+// Per-operation latency histograms and a Chrome trace_event log for DatabaseManager calls.
+// Off by default; a disabled QueryTimer costs one relaxed atomic load.
+class QueryTrace
+{
+public:
+    static bool enabled() { return active.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on);
+
+    // CEG_QUERY_TRACE=1 enables tracing with the default trace file; any other value is the trace file path
+    static void configureFromEnvironment();
+
+    static qint64 now();
+    static void record(const char *operation, qint64 startNs, qint64 endNs, qint64 rows);
+
+    // count, p50/p90/p99/max latency and mean rows per operation
+    static QString summary();
+    // chrome://tracing / Perfetto JSON; events beyond the first million are dropped
+    static bool writeChromeTrace(const QString &path);
+    // Prints the summary and writes the trace file, if tracing is on
+    static void dump();
+
+private:
+    static std::atomic<bool> active;
+};
+
+// Times one DatabaseManager call from construction to scope exit
+class QueryTimer
+{
+public:
+    explicit QueryTimer(const char *operation) :
+        operation(operation), startNs(QueryTrace::enabled() ? QueryTrace::now() : -1) {}
+    ~QueryTimer() {
+        if (startNs >= 0) {
+            QueryTrace::record(operation, startNs, QueryTrace::now(), rows);
+        }
+    }
+
+    QueryTimer(const QueryTimer&) = delete;
+    QueryTimer& operator=(const QueryTimer&) = delete;
+
+    void setRows(qint64 count) { rows = count; }
+
+private:
+    const char *operation;
+    qint64 startNs;
+    qint64 rows = -1;
+};
+
+#endif
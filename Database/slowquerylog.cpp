@@ -0,0 +1,284 @@
+#include "slowquerylog.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QDateTime>
+#include <QHash>
+#include <QVector>
+#include <QVariant>
+#include <QFile>
+#include <QDebug>
+
+namespace {
+
+const qint64 kMaxLogBytes = 1024 * 1024;
+const int kLogGenerations = 3;
+const int kMaxBindChars = 200;
+
+// Bind positions that carry a users.password value: "password = ?" comparisons and the
+// password column of an INSERT column list. Any other statement naming the column has
+// every value redacted.
+QSet<int> passwordBinds(const QString &sql, int bindCount) {
+    QSet<int> positions;
+    if (!sql.contains("password", Qt::CaseInsensitive)) {
+        return positions;
+    }
+
+    static const QRegularExpression compare("\\bpassword\\s*=\\s*\\?",
+                                            QRegularExpression::CaseInsensitiveOption);
+    auto matches = compare.globalMatch(sql);
+    while (matches.hasNext()) {
+        QRegularExpressionMatch match = matches.next();
+        positions.insert(int(sql.left(match.capturedEnd()).count('?')) - 1);
+    }
+
+    static const QRegularExpression insert("\\bINSERT\\s+(?:OR\\s+\\w+\\s+)?INTO\\s+users\\s*\\(([^)]*)\\)\\s*VALUES\\s*\\(",
+                                           QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch match = insert.match(sql);
+    if (match.hasMatch()) {
+        int first = int(sql.left(match.capturedEnd()).count('?'));
+        QStringList columns = match.captured(1).split(',');
+        for (int i = 0; i < columns.size(); ++i) {
+            if (columns[i].trimmed().compare("password", Qt::CaseInsensitive) == 0) {
+                positions.insert(first + i);
+            }
+        }
+    }
+
+    if (positions.isEmpty()) {
+        for (int i = 0; i < bindCount; ++i) {
+            positions.insert(i);
+        }
+    }
+    return positions;
+}
+
+QString formatBinds(const QString &sql, const QVariantList &values) {
+    QSet<int> redacted = passwordBinds(sql, int(values.size()));
+    QStringList binds;
+    for (int i = 0; i < values.size(); ++i) {
+        QString text;
+        if (redacted.contains(i)) {
+            text = "<redacted>";
+        } else if (values[i].isNull()) {
+            text = "NULL";
+        } else if (values[i].typeId() == QMetaType::QString) {
+            text = values[i].toString();
+            if (text.size() > kMaxBindChars) {
+                text = text.left(kMaxBindChars) + "...";
+            }
+            text = "'" + text + "'";
+        } else {
+            text = values[i].toString();
+        }
+        binds.append(QString("[%1] %2").arg(i + 1).arg(text));
+    }
+    return binds.isEmpty() ? QString("none") : binds.join(", ");
+}
+
+struct PlanStep {
+    int id;
+    int parent;
+    QString detail;
+};
+
+struct Plan {
+    QVector<PlanStep> steps;
+    QString error;  // set when EXPLAIN itself failed
+};
+
+// "?" placeholders outside string literals, quoted identifiers and comments
+int placeholderCount(const QString &sql) {
+    int count = 0;
+    for (int i = 0; i < sql.size(); ++i) {
+        QChar c = sql[i];
+        if (c == '\'' || c == '"' || c == '`') {
+            int end = int(sql.indexOf(c, i + 1));
+            i = end < 0 ? int(sql.size()) : end;
+        } else if (c == '-' && sql.mid(i, 2) == "--") {
+            int end = int(sql.indexOf('\n', i));
+            i = end < 0 ? int(sql.size()) : end;
+        } else if (c == '/' && sql.mid(i, 2) == "/*") {
+            int end = int(sql.indexOf("*/", i + 2));
+            i = end < 0 ? int(sql.size()) : end + 1;
+        } else if (c == '?') {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// QSQLite refuses to run a statement unless every placeholder has a value, so any
+// placeholder without one is bound to NULL; the plan still shows which indexes are usable
+Plan explain(const QString &connectionName, const QString &sql, const QVariantList &values) {
+    Plan plan;
+    QSqlQuery query(QSqlDatabase::database(connectionName, false));
+    if (!query.prepare("EXPLAIN QUERY PLAN " + sql)) {
+        plan.error = query.lastError().text();
+        return plan;
+    }
+    int placeholders = qMax(placeholderCount(sql), int(values.size()));
+    for (int i = 0; i < placeholders; ++i) {
+        query.bindValue(i, i < values.size() ? values[i] : QVariant());
+    }
+    if (!query.exec()) {
+        plan.error = query.lastError().text();
+        return plan;
+    }
+    while (query.next()) {
+        plan.steps.append({query.value(0).toInt(), query.value(1).toInt(), query.value(3).toString()});
+    }
+    return plan;
+}
+
+QString formatPlan(const Plan &plan) {
+    if (!plan.error.isEmpty()) {
+        return "  (EXPLAIN failed: " + plan.error + ")\n";
+    }
+    if (plan.steps.isEmpty()) {
+        return "  (no plan)\n";
+    }
+    QHash<int, int> depth;
+    QString text;
+    for (const PlanStep &step : plan.steps) {
+        int level = depth.value(step.parent, 0) + 1;
+        depth.insert(step.id, level);
+        text += QString(level * 2, ' ') + step.detail + "\n";
+    }
+    return text;
+}
+
+// "SCAN orders", or "SCAN o" where o aliases orders, reads every row of the table
+QStringList fullScans(const QString &sql, const QVector<PlanStep> &steps) {
+    QSet<QString> names = {"orders", "order_items"};
+    static const QRegularExpression alias("\\b(orders|order_items)\\s+(?:AS\\s+)?(\\w+)",
+                                          QRegularExpression::CaseInsensitiveOption);
+    static const QSet<QString> keywords = {"where", "join", "inner", "left", "cross", "on", "set",
+                                           "order", "group", "limit", "union", "values", "using"};
+    auto matches = alias.globalMatch(sql);
+    while (matches.hasNext()) {
+        QRegularExpressionMatch match = matches.next();
+        if (!keywords.contains(match.captured(2).toLower())) {
+            names.insert(match.captured(2));
+        }
+    }
+
+    QStringList scans;
+    for (const PlanStep &step : steps) {
+        if (step.detail.startsWith("SCAN ") && names.contains(step.detail.section(' ', 1, 1))) {
+            scans.append(step.detail);
+        }
+    }
+    return scans;
+}
+
+}
+
+void SlowQueryLog::setThresholdMs(int milliseconds) {
+    thresholdNs.store(milliseconds < 0 ? -1 : qint64(milliseconds) * 1000000, std::memory_order_relaxed);
+}
+
+int SlowQueryLog::thresholdMs() const {
+    qint64 ns = thresholdNs.load(std::memory_order_relaxed);
+    return ns < 0 ? -1 : int(ns / 1000000);
+}
+
+bool SlowQueryLog::isSlow(qint64 elapsedNs) const {
+    qint64 threshold = thresholdNs.load(std::memory_order_relaxed);
+    return threshold >= 0 && elapsedNs >= threshold;
+}
+
+void SlowQueryLog::setLogPath(const QString &logPath) {
+    QMutexLocker locker(&mutex);
+    path = logPath;
+}
+
+QString SlowQueryLog::logPath() const {
+    QMutexLocker locker(&mutex);
+    return path;
+}
+
+void SlowQueryLog::checkPlan(const QString &connectionName, const QString &sql) {
+    {
+        QMutexLocker locker(&mutex);
+        if (checkedSql.contains(sql) || loggedSql.contains(sql)) {
+            return;
+        }
+        checkedSql.insert(sql);
+    }
+
+    Plan plan = explain(connectionName, sql, {});
+    if (!plan.error.isEmpty()) {
+        QMutexLocker locker(&mutex);
+        write(QString("%1 plan check failed, connection %2\nSQL: %3\nError: %4\n\n")
+                  .arg(QDateTime::currentDateTime().toString(Qt::ISODateWithMs), connectionName, sql, plan.error));
+        return;
+    }
+    QStringList scans = fullScans(sql, plan.steps);
+    if (scans.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    if (loggedSql.contains(sql)) {
+        return;
+    }
+    loggedSql.insert(sql);
+    write(QString("%1 full table scan (%2), connection %3\nSQL: %4\nPlan:\n%5\n")
+              .arg(QDateTime::currentDateTime().toString(Qt::ISODateWithMs), scans.join("; "),
+                   connectionName, sql, formatPlan(plan)));
+}
+
+void SlowQueryLog::record(const QString &connectionName, const QSqlQuery &query, qint64 rows, qint64 elapsedNs) {
+    QString sql = query.lastQuery();
+    {
+        QMutexLocker locker(&mutex);
+        if (loggedSql.contains(sql)) {
+            return;
+        }
+        loggedSql.insert(sql);
+    }
+
+    QVariantList values = query.boundValues();
+    QString entry = QString("%1 slow query %2 ms, %3 rows, connection %4\n")
+                        .arg(QDateTime::currentDateTime().toString(Qt::ISODateWithMs))
+                        .arg(elapsedNs / 1e6, 0, 'f', 1)
+                        .arg(rows)
+                        .arg(connectionName);
+    entry += "SQL: " + sql + "\n";
+    entry += "Binds: " + formatBinds(sql, values) + "\n";
+    entry += "Plan:\n" + formatPlan(explain(connectionName, sql, values)) + "\n";
+
+    QMutexLocker locker(&mutex);
+    write(entry);
+}
+
+void SlowQueryLog::schemaChanged() {
+    QMutexLocker locker(&mutex);
+    checkedSql.clear();
+    loggedSql.clear();
+}
+
+void SlowQueryLog::write(const QString &entry) {
+    if (path.isEmpty()) {
+        qDebug().noquote() << entry;
+        return;
+    }
+
+    QFile file(path);
+    if (file.exists() && file.size() > kMaxLogBytes) {
+        QFile::remove(QString("%1.%2").arg(path).arg(kLogGenerations));
+        for (int i = kLogGenerations - 1; i >= 1; --i) {
+            QFile::rename(QString("%1.%2").arg(path).arg(i), QString("%1.%2").arg(path).arg(i + 1));
+        }
+        QFile::rename(path, path + ".1");
+    }
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "Cannot write slow query log" << path << ":" << file.errorString();
+        return;
+    }
+    file.write(entry.toUtf8());
+}
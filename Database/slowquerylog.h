@@ -0,0 +1,43 @@
+#ifndef SLOWQUERYLOG_H
+#define SLOWQUERYLOG_H
+
+#include <QString>
+#include <QSet>
+#include <QMutex>
+#include <atomic>
+
+class QSqlQuery;
+
+// Writes each statement that runs longer than the threshold to a rotating log file, once per
+// SQL text, with its bind values and EXPLAIN QUERY PLAN. Statements whose plan scans all of
+// orders or order_items are logged as soon as they are first prepared, whatever their timing.
+class SlowQueryLog
+{
+public:
+    // Negative disables the log and the plan checks
+    void setThresholdMs(int milliseconds);
+    int thresholdMs() const;
+    bool enabled() const { return thresholdNs.load(std::memory_order_relaxed) >= 0; }
+    bool isSlow(qint64 elapsedNs) const;
+
+    void setLogPath(const QString &path);
+    QString logPath() const;
+
+    // Both run EXPLAIN QUERY PLAN, so call them on the thread that owns the connection
+    void checkPlan(const QString &connectionName, const QString &sql);
+    void record(const QString &connectionName, const QSqlQuery &query, qint64 rows, qint64 elapsedNs);
+
+    // Plans may differ after a migration, so every statement is checked and logged again
+    void schemaChanged();
+
+private:
+    void write(const QString &entry);
+
+    std::atomic<qint64> thresholdNs{-1};
+    mutable QMutex mutex;
+    QString path;
+    QSet<QString> checkedSql;
+    QSet<QString> loggedSql;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "statementcache.h"
+#include "slowquerylog.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QDebug>
+
+StatementCache::StatementCache(const QString &connectionName, Counters *sharedCounters, SlowQueryLog *slowLog) :
+    connectionName(connectionName),
+    sharedCounters(sharedCounters),
+    slowLog(slowLog)
+{
+}
+
+QSqlQuery &StatementCache::prepare(const QString &id, const QString &sql) {
+    auto it = statements.find(id);
+    if (it != statements.end() && it->second.prepared) {
+        ++hitCount;
+        if (sharedCounters) {
+            sharedCounters->hits.fetch_add(1, std::memory_order_relaxed);
+        }
+        return it->second.query;
+    }
+
+    ++missCount;
+    if (sharedCounters) {
+        sharedCounters->misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (it == statements.end()) {
+        it = statements.emplace(id, Entry{QSqlQuery(QSqlDatabase::database(connectionName)), false}).first;
+    }
+
+    Entry &entry = it->second;
+    entry.query.setForwardOnly(true);
+    entry.prepared = entry.query.prepare(sql);
+    if (!entry.prepared) {
+        qDebug() << "Prepare failed for statement" << id << ":" << entry.query.lastError().text();
+    } else if (slowLog && slowLog->enabled()) {
+        slowLog->checkPlan(connectionName, sql);
+    }
+    return entry.query;
+}
+
+void StatementCache::clear() {
+    statements.clear();
+}
+
+bool StatementCache::timesStatements() const {
+    return slowLog && slowLog->enabled();
+}
+
+void StatementCache::finished(const QSqlQuery &query, qint64 rows, qint64 elapsedNs) {
+    if (sharedCounters && isBusyError(query.lastError())) {
+        sharedCounters->busy.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (elapsedNs >= 0 && slowLog->isSlow(elapsedNs)) {
+        slowLog->record(connectionName, query, query.isSelect() ? rows : query.numRowsAffected(), elapsedNs);
+    }
+}
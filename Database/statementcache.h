@@ -0,0 +1,137 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QString>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <atomic>
+#include <unordered_map>
+
+class SlowQueryLog;
+class StatementCache;
+
+// SQLITE_BUSY or SQLITE_LOCKED: the busy timeout ran out waiting for another connection
+inline bool isBusyError(const QSqlError &error) {
+    return error.nativeErrorCode() == "5" || error.nativeErrorCode() == "6";
+}
+
+// Scoped handle to a cached statement. Resets the statement when it goes out of
+// scope so a half-read SELECT never keeps the read transaction open, and reports
+// busy errors and slow runs to the cache it came from. A run is one exec() and the
+// next() calls after it; only time spent inside those calls counts, so work the caller
+// does between rows, or in other statements meanwhile, is never charged to this one.
+class CachedStatement
+{
+public:
+    explicit CachedStatement(QSqlQuery &query, StatementCache *cache = nullptr);
+    ~CachedStatement();
+
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+
+    QSqlQuery *operator->() { return &query; }
+    QSqlQuery &operator*() { return query; }
+
+    // Use instead of query->exec() and query->next() so runs are timed and their rows counted
+    bool exec() {
+        report();
+        running = true;
+        rows = 0;
+        elapsedNs = 0;
+        if (timed) {
+            timer.start();
+        }
+        bool ok = query.exec();
+        if (timed) {
+            elapsedNs += timer.nsecsElapsed();
+        }
+        return ok;
+    }
+
+    bool next() {
+        if (timed) {
+            timer.start();
+        }
+        bool more = query.next();
+        if (timed) {
+            elapsedNs += timer.nsecsElapsed();
+        }
+        if (!more) {
+            report();
+            return false;
+        }
+        ++rows;
+        return true;
+    }
+
+private:
+    void report();
+
+    QSqlQuery &query;
+    StatementCache *cache;
+    bool timed = false;
+    bool running = false;
+    QElapsedTimer timer;
+    qint64 elapsedNs = 0;
+    qint64 rows = 0;
+};
+
+// Prepared statements for one connection, keyed by a stable statement ID.
+// A hit only rebinds values; SQLite never re-parses or re-plans the SQL.
+class StatementCache
+{
+public:
+    // Process-wide totals shared by the caches of every connection
+    struct Counters {
+        std::atomic<qint64> hits{0};
+        std::atomic<qint64> misses{0};
+        std::atomic<qint64> busy{0};
+    };
+
+    StatementCache(const QString &connectionName, Counters *sharedCounters = nullptr,
+                   SlowQueryLog *slowLog = nullptr);
+
+    QSqlQuery &prepare(const QString &id, const QString &sql);
+    void clear();
+
+    int hits() const { return hitCount; }
+    int misses() const { return missCount; }
+
+    // Whether statements from this cache need timing at all
+    bool timesStatements() const;
+    // Called by CachedStatement once per run; elapsedNs is negative when the run was not timed
+    void finished(const QSqlQuery &query, qint64 rows, qint64 elapsedNs);
+
+private:
+    struct Entry {
+        QSqlQuery query;
+        bool prepared = false;
+    };
+
+    QString connectionName;
+    Counters *sharedCounters;
+    SlowQueryLog *slowLog;
+    std::unordered_map<QString, Entry> statements;
+    int hitCount = 0;
+    int missCount = 0;
+};
+
+inline CachedStatement::CachedStatement(QSqlQuery &query, StatementCache *cache) :
+    query(query), cache(cache), timed(cache && cache->timesStatements())
+{
+}
+
+inline CachedStatement::~CachedStatement() {
+    report();
+    query.finish();
+}
+
+inline void CachedStatement::report() {
+    if (running && cache) {
+        cache->finished(query, rows, timed ? elapsedNs : -1);
+    }
+    running = false;
+}
+
+#endif
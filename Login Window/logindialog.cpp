@@ -5,6 +5,16 @@
 #include <QFont>
 #include <QPalette>
 
+namespace {
+
+struct LoginResult {
+    bool valid = false;
+    QString userType;
+    int userId = -1;
+};
+
+}
+
 LoginDialog::LoginDialog(QWidget *parent) :
     QDialog(parent),
     ui(new Ui::logindialog)
@@ -50,48 +60,55 @@ void LoginDialog::on_loginButton_clicked()
     ui->loginButton->setText("Logging in...");
     ui->loginButton->setEnabled(false);
     ui->registerButton->setEnabled(false);
-    QApplication::processEvents();
-
-    QString actualUserType;
-    if (DatabaseManager::instance().validateLogin(username, password, actualUserType)) {
-        if (actualUserType.toLower() == userType.toLower()) {
-            int userId = DatabaseManager::instance().getUserId(username);
-            if (userId != -1) {
-                emit loginSuccessful(userId, userType, username);
-                // Don't close here, let main.cpp handle the transition
+
+    // Credentials are checked on the database worker pool so the dialog keeps painting
+    DatabaseManager::instance().runAsync([username, password]() {
+        LoginResult result;
+        result.valid = DatabaseManager::instance().validateLogin(username, password, result.userType);
+        if (result.valid) {
+            result.userId = DatabaseManager::instance().getUserId(username);
+        }
+        return result;
+    }).then(this, [this, username, userType](const LoginResult &result) {
+        if (result.valid) {
+            if (result.userType.toLower() == userType.toLower()) {
+                if (result.userId != -1) {
+                    emit loginSuccessful(result.userId, userType, username);
+                    // Don't close here, let main.cpp handle the transition
+                } else {
+                    QMessageBox msgBox;
+                    msgBox.setWindowTitle("Login Error");
+                    msgBox.setText("Failed to get user information.");
+                    msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+                    msgBox.setIcon(QMessageBox::Warning);
+                    msgBox.exec();
+                }
             } else {
                 QMessageBox msgBox;
                 msgBox.setWindowTitle("Login Error");
-                msgBox.setText("Failed to get user information.");
+                msgBox.setText(QString("You are registered as a %1, but selected %2.")
+                                   .arg(result.userType).arg(userType));
                 msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
                 msgBox.setIcon(QMessageBox::Warning);
                 msgBox.exec();
             }
         } else {
             QMessageBox msgBox;
-            msgBox.setWindowTitle("Login Error");
-            msgBox.setText(QString("You are registered as a %1, but selected %2.")
-                               .arg(actualUserType).arg(userType));
+            msgBox.setWindowTitle("Login Failed");
+            msgBox.setText("Invalid username or password.\n\n"
+                           "Sample accounts:\n"
+                           "Student: student1 / pass123\n"
+                           "Vendor: vendor1 / pass123");
             msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
             msgBox.setIcon(QMessageBox::Warning);
             msgBox.exec();
         }
-    } else {
-        QMessageBox msgBox;
-        msgBox.setWindowTitle("Login Failed");
-        msgBox.setText("Invalid username or password.\n\n"
-                       "Sample accounts:\n"
-                       "Student: student1 / pass123\n"
-                       "Vendor: vendor1 / pass123");
-        msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Warning);
-        msgBox.exec();
-    }
 
-    // Reset button
-    ui->loginButton->setText("LOGIN");
-    ui->loginButton->setEnabled(true);
-    ui->registerButton->setEnabled(true);
+        // Reset button
+        ui->loginButton->setText("LOGIN");
+        ui->loginButton->setEnabled(true);
+        ui->registerButton->setEnabled(true);
+    });
 }
 
 void LoginDialog::on_registerButton_clicked()
@@ -128,32 +145,35 @@ void LoginDialog::on_registerButton_clicked()
     ui->registerButton->setText("Registering...");
     ui->registerButton->setEnabled(false);
     ui->loginButton->setEnabled(false);
-    QApplication::processEvents();
 
     // Just try to register - the database will handle the duplicate check
-    if (DatabaseManager::instance().registerUser(username, password, userType)) {
-        QMessageBox msgBox;
-        msgBox.setWindowTitle("Registration Successful");
-        msgBox.setText("Account created successfully! You can now login.");
-        msgBox.setStyleSheet("QLabel{color: #2E7D32; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Information);
-        msgBox.exec();
+    DatabaseManager::instance().async(&DatabaseManager::registerUser, username, password, userType,
+                                      QString(), QString())
+        .then(this, [this](bool registered) {
+            if (registered) {
+                QMessageBox msgBox;
+                msgBox.setWindowTitle("Registration Successful");
+                msgBox.setText("Account created successfully! You can now login.");
+                msgBox.setStyleSheet("QLabel{color: #2E7D32; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+                msgBox.setIcon(QMessageBox::Information);
+                msgBox.exec();
 
-        ui->passwordEdit->clear();
-        ui->usernameEdit->setFocus();
-    } else {
-        QMessageBox msgBox;
-        msgBox.setWindowTitle("Registration Failed");
-        msgBox.setText("Username already exists. Please try a different username.");
-        msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Warning);
-        msgBox.exec();
-        ui->usernameEdit->setFocus();
-        ui->usernameEdit->selectAll();
-    }
+                ui->passwordEdit->clear();
+                ui->usernameEdit->setFocus();
+            } else {
+                QMessageBox msgBox;
+                msgBox.setWindowTitle("Registration Failed");
+                msgBox.setText("Username already exists. Please try a different username.");
+                msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+                msgBox.setIcon(QMessageBox::Warning);
+                msgBox.exec();
+                ui->usernameEdit->setFocus();
+                ui->usernameEdit->selectAll();
+            }
 
-    // Reset button
-    ui->registerButton->setText("REGISTER");
-    ui->registerButton->setEnabled(true);
-    ui->loginButton->setEnabled(true);
+            // Reset button
+            ui->registerButton->setText("REGISTER");
+            ui->registerButton->setEnabled(true);
+            ui->loginButton->setEnabled(true);
+        });
 }
@@ -0,0 +1,254 @@
+#include "orderserver.h"
+#include "orderprotocol.h"
+#include "databasemanager.h"
+#include <QLocalSocket>
+#include <QtConcurrent/QtConcurrentRun>
+#include <tuple>
+#include <type_traits>
+
+using OrderProtocol::Op;
+using OrderProtocol::Status;
+
+namespace {
+
+// Reads the call's arguments in declaration order, runs it, and writes the result
+template <typename Ret, typename... Params>
+void invoke(QDataStream &in, QDataStream &out, Ret (DatabaseManager::*method)(Params...)) {
+    std::tuple<std::decay_t<Params>...> args;
+    std::apply([&in](auto &...arg) { (in >> ... >> arg); }, args);
+    if (in.status() != QDataStream::Ok) {
+        out << quint8(Status::BadRequest);
+        return;
+    }
+    Ret result = std::apply([method](auto &...arg) {
+        return (DatabaseManager::instance().*method)(arg...);
+    }, args);
+    out << quint8(Status::Ok) << result;
+}
+
+}
+
+OrderServer::OrderServer(QObject *parent) :
+    QObject(parent)
+{
+    writePool.setMaxThreadCount(1);
+    writePool.setExpiryTimeout(-1);
+    connect(&server, &QLocalServer::newConnection, this, &OrderServer::onNewConnection);
+    connect(&archiveTimer, &QTimer::timeout, this, &OrderServer::runArchivePass);
+    // Emitted on the write thread; queued to this one
+    connect(&DatabaseManager::instance(), &DatabaseManager::orderStatusChanged,
+            this, &OrderServer::broadcastOrderStatus);
+}
+
+bool OrderServer::listen(const QString &serverName) {
+    QLocalSocket probe;
+    probe.connectToServer(serverName);
+    if (probe.waitForConnected(1000)) {
+        lastError = QString("another order service is already listening on %1").arg(serverName);
+        return false;
+    }
+
+    // Clears a socket file left behind by a service that crashed
+    QLocalServer::removeServer(serverName);
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    if (!server.listen(serverName)) {
+        lastError = server.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString OrderServer::errorString() const {
+    return lastError;
+}
+
+void OrderServer::startArchiving(int olderThanDays, int intervalMs) {
+    archiveAfterDays = olderThanDays;
+    archiveTimer.start(intervalMs);
+    runArchivePass();
+}
+
+void OrderServer::runArchivePass() {
+    // Skip a tick while the previous pass is still running
+    if (archiving) {
+        return;
+    }
+    archiving = true;
+    int olderThanDays = archiveAfterDays;
+    QtConcurrent::run(&writePool, [olderThanDays]() {
+        return DatabaseManager::instance().archiveCompletedOrders(olderThanDays);
+    }).then(this, [this](int) {
+        archiving = false;
+    });
+}
+
+void OrderServer::onNewConnection() {
+    while (QLocalSocket *socket = server.nextPendingConnection()) {
+        sessions.insert(socket, Session());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { readRequests(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            sessions.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void OrderServer::readRequests(QLocalSocket *socket) {
+    auto it = sessions.find(socket);
+    if (it == sessions.end()) {
+        return;
+    }
+
+    it->buffer += socket->readAll();
+    QByteArray request;
+    bool corrupt = false;
+    while (OrderProtocol::takeFrame(it->buffer, request, corrupt)) {
+        it->pending.enqueue(request);
+    }
+    if (corrupt) {
+        qDebug() << "Dropping order service client after an oversized frame";
+        socket->abort();
+        return;
+    }
+    dispatchNext(socket);
+}
+
+void OrderServer::dispatchNext(QLocalSocket *socket) {
+    auto it = sessions.find(socket);
+    if (it == sessions.end() || it->busy || it->pending.isEmpty()) {
+        return;
+    }
+
+    QByteArray request = it->pending.dequeue();
+    it->busy = true;
+
+    QDataStream peek(request);
+    peek.setVersion(OrderProtocol::kStreamVersion);
+    quint16 op = 0;
+    peek >> op;
+
+    if (Op(op) == Op::Subscribe) {
+        it->subscriber = true;
+        it->busy = false;
+        it->pending.clear();
+        return;
+    }
+
+    QFuture<QByteArray> reply = OrderProtocol::isWrite(Op(op))
+        ? QtConcurrent::run(&writePool, &OrderServer::execute, request)
+        : DatabaseManager::instance().runAsync([request]() { return execute(request); });
+
+    // Delivery is dropped if the client disconnects first
+    reply.then(socket, [this, socket](const QByteArray &payload) {
+        socket->write(OrderProtocol::frame(payload));
+        auto it = sessions.find(socket);
+        if (it != sessions.end()) {
+            it->busy = false;
+        }
+        dispatchNext(socket);
+    });
+}
+
+void OrderServer::broadcastOrderStatus(int orderId, const QString &status) {
+    QByteArray event;
+    {
+        QDataStream out(&event, QIODevice::WriteOnly);
+        out.setVersion(OrderProtocol::kStreamVersion);
+        out << quint16(Op::OrderStatusChanged) << orderId << status;
+    }
+    QByteArray data = OrderProtocol::frame(event);
+    for (auto it = sessions.cbegin(); it != sessions.cend(); ++it) {
+        if (it->subscriber) {
+            it.key()->write(data);
+        }
+    }
+}
+
+QByteArray OrderServer::execute(const QByteArray &request) {
+    DatabaseManager &db = DatabaseManager::instance();
+    QDataStream in(request);
+    in.setVersion(OrderProtocol::kStreamVersion);
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+    out.setVersion(OrderProtocol::kStreamVersion);
+
+    quint16 op = 0;
+    in >> op;
+    switch (Op(op)) {
+    case Op::Hello:
+        out << quint8(Status::Ok) << OrderProtocol::kVersion;
+        break;
+    case Op::RegisterUser: invoke(in, out, &DatabaseManager::registerUser); break;
+    case Op::ValidateLogin: {
+        QString username;
+        QString password;
+        QString userType;
+        in >> username >> password;
+        bool valid = db.validateLogin(username, password, userType);
+        out << quint8(Status::Ok) << qMakePair(valid, userType);
+        break;
+    }
+    case Op::GetUserId: invoke(in, out, &DatabaseManager::getUserId); break;
+    case Op::UsernameExists: invoke(in, out, &DatabaseManager::usernameExists); break;
+    case Op::GetUsername: invoke(in, out, &DatabaseManager::getUsername); break;
+    case Op::RegisterShop: invoke(in, out, &DatabaseManager::registerShop); break;
+    case Op::GetShopId: invoke(in, out, &DatabaseManager::getShopId); break;
+    case Op::GetShopName: invoke(in, out, &DatabaseManager::getShopName); break;
+    case Op::GetAllShops: invoke(in, out, &DatabaseManager::getAllShops); break;
+    case Op::AddProduct: invoke(in, out, &DatabaseManager::addProduct); break;
+    case Op::UpdateProductAvailability: invoke(in, out, &DatabaseManager::updateProductAvailability); break;
+    case Op::GetProductsByShop: invoke(in, out, &DatabaseManager::getProductsByShop); break;
+    case Op::GetAllAvailableProducts: invoke(in, out, &DatabaseManager::getAllAvailableProducts); break;
+    case Op::SearchProducts: invoke(in, out, &DatabaseManager::searchProducts); break;
+    case Op::ImportProducts: {
+        int shopId = -1;
+        QString filePath;
+        in >> shopId >> filePath;
+        QPromise<ProductImportResult> promise;
+        QFuture<ProductImportResult> result = promise.future();
+        promise.start();
+        db.importProducts(promise, shopId, filePath);
+        promise.finish();
+        out << quint8(Status::Ok) << result.result();
+        break;
+    }
+    case Op::ExportOrders: {
+        int shopId = -1;
+        QDate month;
+        ExportFormat format = ExportFormat::Csv;
+        QString filePath;
+        in >> shopId >> month >> format >> filePath;
+        QPromise<OrderExportResult> promise;
+        QFuture<OrderExportResult> result = promise.future();
+        promise.start();
+        db.exportOrders(promise, shopId, month, format, filePath);
+        promise.finish();
+        out << quint8(Status::Ok) << result.result();
+        break;
+    }
+    case Op::PlaceOrder: invoke(in, out, &DatabaseManager::placeOrder); break;
+    case Op::CreateOrder: invoke(in, out, &DatabaseManager::createOrder); break;
+    case Op::AddOrderItem: invoke(in, out, &DatabaseManager::addOrderItem); break;
+    case Op::UpdateOrderStatus: invoke(in, out, &DatabaseManager::updateOrderStatus); break;
+    case Op::GetOrdersByStudent: invoke(in, out, &DatabaseManager::getOrdersByStudent); break;
+    case Op::GetOrdersByShop: invoke(in, out, &DatabaseManager::getOrdersByShop); break;
+    case Op::GetOrderItems: invoke(in, out, &DatabaseManager::getOrderItems); break;
+    case Op::SaveCartItem: invoke(in, out, &DatabaseManager::saveCartItem); break;
+    case Op::ClearSavedCart: invoke(in, out, &DatabaseManager::clearSavedCart); break;
+    case Op::GetSavedCart: invoke(in, out, &DatabaseManager::getSavedCart); break;
+    case Op::GetOrdersByStudentPage: invoke(in, out, &DatabaseManager::getOrdersByStudentPage); break;
+    case Op::GetOrdersByShopPage: invoke(in, out, &DatabaseManager::getOrdersByShopPage); break;
+    case Op::ArchiveCompletedOrders: invoke(in, out, &DatabaseManager::archiveCompletedOrders); break;
+    case Op::GetOrderChangeSequence: invoke(in, out, &DatabaseManager::getOrderChangeSequence); break;
+    case Op::GetOrderChangesSince: invoke(in, out, &DatabaseManager::getOrderChangesSince); break;
+    case Op::GetShopStats: invoke(in, out, &DatabaseManager::getShopStats); break;
+    case Op::GetCatalog: invoke(in, out, &DatabaseManager::catalog); break;
+    case Op::GetCatalogVersion:
+        out << quint8(Status::Ok) << db.catalogVersion();
+        break;
+    default:
+        out << quint8(Status::UnknownOp);
+        break;
+    }
+    return reply;
+}
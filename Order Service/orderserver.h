@@ -0,0 +1,61 @@
+#ifndef ORDERSERVER_H
+#define ORDERSERVER_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QThreadPool>
+#include <QTimer>
+#include <QHash>
+#include <QQueue>
+#include <QByteArray>
+
+class QLocalSocket;
+
+// Serves DatabaseManager calls to kiosk clients over a local socket. Reads run on the
+// DatabaseManager worker pool; writes run one at a time on a single-thread pool, so every
+// write, archiving included, goes through one SQLite connection instead of competing for
+// the file lock.
+class OrderServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OrderServer(QObject *parent = nullptr);
+
+    // Fails if another service already answers on serverName
+    bool listen(const QString &serverName);
+    QString errorString() const;
+
+    // Archives completed orders on the write thread now and then every intervalMs. Writes
+    // from kiosks wait while a pass runs; after the first, a pass moves about intervalMs worth.
+    void startArchiving(int olderThanDays, int intervalMs);
+
+    // Runs one request payload against the local database and returns the reply payload
+    static QByteArray execute(const QByteArray &request);
+
+private slots:
+    void onNewConnection();
+    void broadcastOrderStatus(int orderId, const QString &status);
+
+private:
+    struct Session {
+        QByteArray buffer;
+        QQueue<QByteArray> pending;
+        bool busy = false;
+        bool subscriber = false;  // receives events only
+    };
+
+    void readRequests(QLocalSocket *socket);
+    void dispatchNext(QLocalSocket *socket);
+    void runArchivePass();
+
+    QLocalServer server;
+    QThreadPool writePool;
+    QHash<QLocalSocket*, Session> sessions;
+    QTimer archiveTimer;
+    int archiveAfterDays = 0;
+    bool archiving = false;
+    QString lastError;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include "databasemanager.h"
+#include "orderprotocol.h"
+#include "orderserver.h"
+#include "querytrace.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QueryTrace::configureFromEnvironment();
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Order service: owns the CEG SQUARE database and serves the kiosks");
+    parser.addHelpOption();
+    parser.addOption({"db", "SQLite database file.", "path", "ceg_square.db"});
+    parser.addOption({"name", "Local socket name the kiosks connect to.", "name", OrderProtocol::kDefaultServerName});
+    parser.addOption({"archive-days", "Archive completed orders older than this many days.", "days", "30"});
+    parser.process(app);
+
+    DatabaseManager &db = DatabaseManager::instance();
+    if (!db.initializeDatabase(parser.value("db"))) {
+        err << "Failed to open " << parser.value("db") << "\n";
+        return 1;
+    }
+    OrderServer server;
+    // Keep only recent orders in the hot tables; check hourly
+    server.startArchiving(qMax(1, parser.value("archive-days").toInt()), 60 * 60 * 1000);
+    if (!server.listen(parser.value("name"))) {
+        err << "Cannot listen on " << parser.value("name") << ": " << server.errorString() << "\n";
+        return 1;
+    }
+    out << "Order service listening on " << parser.value("name") << " for " << parser.value("db") << "\n";
+    out.flush();
+
+    int result = app.exec();
+    QueryTrace::dump();
+    return result;
+}
@@ -0,0 +1,110 @@
+#include "cart.h"
+
+Cart::Cart(QObject *parent) :
+    QObject(parent)
+{
+}
+
+qint64 Cart::linePaise(const CartItem &item)
+{
+    return qRound64(item.price * 100) * item.quantity;
+}
+
+void Cart::adjust(int shopId, qint64 paise, int lines)
+{
+    ShopTotal &shop = shops[shopId];
+    shop.paise += paise;
+    shop.lines += lines;
+    if (shop.lines == 0) {
+        shops.remove(shopId);
+    }
+    totalPaise += paise;
+}
+
+int Cart::add(const Product &product, int quantity)
+{
+    if (quantity <= 0) {
+        return rows.value(product.id, -1);
+    }
+
+    auto it = rows.constFind(product.id);
+    if (it != rows.constEnd()) {
+        int row = it.value();
+        CartItem &item = items[row];
+        item.quantity += quantity;
+        adjust(item.shopId, qRound64(item.price * 100) * quantity, 0);
+        emit itemChanged(row);
+        emit totalChanged(total());
+        return row;
+    }
+
+    int row = int(items.size());
+    items.append({product.id, product.name, product.shopName, product.price, quantity, product.shopId});
+    rows.insert(product.id, row);
+    adjust(product.shopId, linePaise(items[row]), 1);
+    emit itemAdded(row);
+    emit totalChanged(total());
+    return row;
+}
+
+void Cart::setQuantity(int productId, int quantity)
+{
+    if (quantity <= 0) {
+        remove(productId);
+        return;
+    }
+    auto it = rows.constFind(productId);
+    if (it == rows.constEnd()) {
+        return;
+    }
+    int row = it.value();
+    CartItem &item = items[row];
+    if (item.quantity == quantity) {
+        return;
+    }
+    adjust(item.shopId, qRound64(item.price * 100) * (quantity - item.quantity), 0);
+    item.quantity = quantity;
+    emit itemChanged(row);
+    emit totalChanged(total());
+}
+
+void Cart::remove(int productId)
+{
+    auto it = rows.constFind(productId);
+    if (it == rows.constEnd()) {
+        return;
+    }
+    int row = it.value();
+    rows.erase(it);
+    adjust(items[row].shopId, -linePaise(items[row]), -1);
+
+    // Carts are small, so renumbering the later rows is cheap
+    items.remove(row);
+    for (int i = row; i < items.size(); ++i) {
+        rows[items[i].productId] = i;
+    }
+
+    emit itemRemoved(row);
+    emit totalChanged(total());
+}
+
+void Cart::clear()
+{
+    items.clear();
+    rows.clear();
+    shops.clear();
+    totalPaise = 0;
+    emit cleared();
+    emit totalChanged(0.0);
+}
+
+int Cart::quantity(int productId) const
+{
+    auto it = rows.constFind(productId);
+    return it == rows.constEnd() ? 0 : items[it.value()].quantity;
+}
+
+double Cart::subtotal(int shopId) const
+{
+    return shops.value(shopId).paise / 100.0;
+}
@@ -0,0 +1,71 @@
+#ifndef CART_H
+#define CART_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include "databasemanager.h"
+
+struct CartItem {
+    int productId;
+    QString productName;
+    QString shopName;
+    double price;
+    int quantity;
+    int shopId;
+};
+
+Q_DECLARE_TYPEINFO(CartItem, Q_RELOCATABLE_TYPE);
+
+// Cart lines indexed by product id, with per-shop subtotals and the total kept up to date on
+// every change, so reading a total never walks the cart. Sums are kept in whole paise so adding and
+// removing lines never drifts. Signals name the row that changed so a view redraws only it.
+class Cart : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Cart(QObject *parent = nullptr);
+
+    // Adds quantity to the product's line, creating it at the end if needed; returns its row
+    int add(const Product &product, int quantity);
+    // A quantity of 0 or less removes the line
+    void setQuantity(int productId, int quantity);
+    // Later lines move up one row, so the cart stays in the order lines were added
+    void remove(int productId);
+    void clear();
+
+    bool isEmpty() const { return items.isEmpty(); }
+    int size() const { return int(items.size()); }
+    const CartItem &item(int row) const { return items[row]; }
+    const QVector<CartItem> &lines() const { return items; }
+    bool contains(int productId) const { return rows.contains(productId); }
+    int quantity(int productId) const;
+
+    double total() const { return totalPaise / 100.0; }
+    double subtotal(int shopId) const;
+    int shopCount() const { return int(shops.size()); }
+
+signals:
+    void itemAdded(int row);
+    void itemChanged(int row);
+    void itemRemoved(int row);
+    void cleared();
+    void totalChanged(double total);
+
+private:
+    struct ShopTotal {
+        qint64 paise = 0;
+        int lines = 0;
+    };
+
+    static qint64 linePaise(const CartItem &item);
+    void adjust(int shopId, qint64 paise, int lines);
+
+    QVector<CartItem> items;
+    QHash<int, int> rows;  // product id -> row
+    QHash<int, ShopTotal> shops;
+    qint64 totalPaise = 0;
+};
+
+#endif
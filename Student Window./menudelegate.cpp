@@ -0,0 +1,148 @@
+#include "menudelegate.h"
+#include "menumodel.h"
+#include <QApplication>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QSpinBox>
+#include <QStyle>
+
+namespace {
+
+QStyle *styleFor(const QStyleOptionViewItem &option)
+{
+    return option.widget ? option.widget->style() : QApplication::style();
+}
+
+}
+
+MenuDelegate::MenuDelegate(QObject *parent) :
+    QStyledItemDelegate(parent)
+{
+}
+
+QStyleOptionSpinBox MenuDelegate::spinBoxOption(const QStyleOptionViewItem &option, int quantity) const
+{
+    QStyleOptionSpinBox spin;
+    spin.direction = option.direction;
+    spin.palette = option.palette;
+    spin.fontMetrics = option.fontMetrics;
+    spin.rect = option.rect.adjusted(2, 2, -2, -2);
+    spin.state = option.state | QStyle::State_Enabled;
+    spin.subControls = QStyle::SC_SpinBoxFrame | QStyle::SC_SpinBoxUp | QStyle::SC_SpinBoxDown |
+                       QStyle::SC_SpinBoxEditField;
+    spin.buttonSymbols = QAbstractSpinBox::UpDownArrows;
+    spin.frame = true;
+    spin.stepEnabled = QAbstractSpinBox::StepNone;
+    if (quantity > MenuModel::MinQuantity) {
+        spin.stepEnabled |= QAbstractSpinBox::StepDownEnabled;
+    }
+    if (quantity < MenuModel::MaxQuantity) {
+        spin.stepEnabled |= QAbstractSpinBox::StepUpEnabled;
+    }
+    return spin;
+}
+
+void MenuDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyle *style = styleFor(option);
+
+    if (index.column() == MenuModel::QuantityColumn) {
+        QStyleOptionViewItem cell = option;
+        initStyleOption(&cell, index);
+        cell.text.clear();
+        style->drawControl(QStyle::CE_ItemViewItem, &cell, painter, option.widget);
+
+        int quantity = index.data(Qt::EditRole).toInt();
+        QStyleOptionSpinBox spin = spinBoxOption(option, quantity);
+        style->drawComplexControl(QStyle::CC_SpinBox, &spin, painter, option.widget);
+        QRect field = style->subControlRect(QStyle::CC_SpinBox, &spin, QStyle::SC_SpinBoxEditField, option.widget);
+        painter->save();
+        painter->setPen(option.palette.color(QPalette::Text));
+        painter->drawText(field.adjusted(2, 0, -2, 0), Qt::AlignVCenter | Qt::AlignLeft, QString::number(quantity));
+        painter->restore();
+        return;
+    }
+
+    if (index.column() == MenuModel::AddColumn) {
+        // Same look as the per-row QPushButton it replaces
+        QRect button = option.rect.adjusted(2, 2, -2, -2);
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(QColor("#2196F3"));
+        painter->drawRoundedRect(button, 3, 3);
+        painter->setPen(Qt::white);
+        painter->drawText(button, Qt::AlignCenter, index.data().toString());
+        painter->restore();
+        return;
+    }
+
+    QStyledItemDelegate::paint(painter, option, index);
+}
+
+bool MenuDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                               const QModelIndex &index)
+{
+    if (event->type() != QEvent::MouseButtonRelease) {
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+    QMouseEvent *mouse = static_cast<QMouseEvent*>(event);
+    QPoint position = mouse->position().toPoint();
+    if (mouse->button() != Qt::LeftButton || !option.rect.contains(position)) {
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+
+    if (index.column() == MenuModel::AddColumn) {
+        emit addToCartClicked(index);
+        return true;
+    }
+
+    if (index.column() == MenuModel::QuantityColumn) {
+        int quantity = index.data(Qt::EditRole).toInt();
+        QStyleOptionSpinBox spin = spinBoxOption(option, quantity);
+        QStyle::SubControl hit = styleFor(option)->hitTestComplexControl(QStyle::CC_SpinBox, &spin, position,
+                                                                        option.widget);
+        if (hit == QStyle::SC_SpinBoxUp) {
+            model->setData(index, quantity + 1, Qt::EditRole);
+            return true;
+        }
+        if (hit == QStyle::SC_SpinBoxDown) {
+            model->setData(index, quantity - 1, Qt::EditRole);
+            return true;
+        }
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+QWidget *MenuDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &option,
+                                    const QModelIndex &index) const
+{
+    if (index.column() != MenuModel::QuantityColumn) {
+        return QStyledItemDelegate::createEditor(parent, option, index);
+    }
+    QSpinBox *editor = new QSpinBox(parent);
+    editor->setRange(MenuModel::MinQuantity, MenuModel::MaxQuantity);
+    editor->setFrame(false);
+    return editor;
+}
+
+void MenuDelegate::setEditorData(QWidget *editor, const QModelIndex &index) const
+{
+    QSpinBox *spin = qobject_cast<QSpinBox*>(editor);
+    if (spin) {
+        spin->setValue(index.data(Qt::EditRole).toInt());
+        return;
+    }
+    QStyledItemDelegate::setEditorData(editor, index);
+}
+
+void MenuDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const
+{
+    QSpinBox *spin = qobject_cast<QSpinBox*>(editor);
+    if (spin) {
+        spin->interpretText();
+        model->setData(index, spin->value(), Qt::EditRole);
+        return;
+    }
+    QStyledItemDelegate::setModelData(editor, model, index);
+}
@@ -0,0 +1,34 @@
+#ifndef MENUDELEGATE_H
+#define MENUDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QStyleOptionSpinBox>
+
+// Paints the quantity spin box and the Add to Cart button of MenuModel rows instead of
+// creating a widget per row. Arrow clicks step the quantity in the model; a real QSpinBox
+// exists only while a quantity cell is being edited from the keyboard or by double-click.
+class MenuDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit MenuDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option,
+                          const QModelIndex &index) const override;
+    void setEditorData(QWidget *editor, const QModelIndex &index) const override;
+    void setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const override;
+
+signals:
+    void addToCartClicked(const QModelIndex &index);
+
+protected:
+    bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                     const QModelIndex &index) override;
+
+private:
+    QStyleOptionSpinBox spinBoxOption(const QStyleOptionViewItem &option, int quantity) const;
+};
+
+#endif
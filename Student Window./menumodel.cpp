@@ -0,0 +1,110 @@
+#include "menumodel.h"
+
+MenuModel::MenuModel(QObject *parent) :
+    QAbstractTableModel(parent)
+{
+}
+
+void MenuModel::setProducts(const QVector<Product> &newProducts)
+{
+    beginResetModel();
+    products = newProducts;
+    endResetModel();
+}
+
+const Product &MenuModel::product(int row) const
+{
+    return products[row];
+}
+
+int MenuModel::quantity(int row) const
+{
+    return quantities.value(products[row].id, MinQuantity);
+}
+
+void MenuModel::setQuantity(int row, int quantity)
+{
+    quantity = qBound(MinQuantity, quantity, MaxQuantity);
+    int productId = products[row].id;
+    if (quantity == MinQuantity) {
+        quantities.remove(productId);
+    } else {
+        quantities.insert(productId, quantity);
+    }
+    QModelIndex cell = index(row, QuantityColumn);
+    emit dataChanged(cell, cell, {Qt::DisplayRole, Qt::EditRole});
+}
+
+int MenuModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(products.size());
+}
+
+int MenuModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant MenuModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= products.size()) {
+        return QVariant();
+    }
+    const Product &item = products[index.row()];
+
+    if (role == Qt::DisplayRole || role == Qt::EditRole) {
+        switch (index.column()) {
+        case NameColumn:
+            return item.name;
+        case ShopColumn:
+            return item.shopName;
+        case PriceColumn:
+            return QString("₹%1").arg(item.price, 0, 'f', 2);
+        case QuantityColumn:
+            return quantity(index.row());
+        case AddColumn:
+            return QString("Add to Cart");
+        }
+    } else if (role == Qt::TextAlignmentRole && index.column() == AddColumn) {
+        return int(Qt::AlignCenter);
+    }
+    return QVariant();
+}
+
+bool MenuModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || index.column() != QuantityColumn || role != Qt::EditRole) {
+        return false;
+    }
+    setQuantity(index.row(), value.toInt());
+    return true;
+}
+
+QVariant MenuModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case NameColumn:
+        return QString("Product");
+    case ShopColumn:
+        return QString("Shop");
+    case PriceColumn:
+        return QString("Price (₹)");
+    case QuantityColumn:
+        return QString("Quantity");
+    case AddColumn:
+        return QString("Add to Cart");
+    }
+    return QVariant();
+}
+
+Qt::ItemFlags MenuModel::flags(const QModelIndex &index) const
+{
+    Qt::ItemFlags flags = QAbstractTableModel::flags(index);
+    if (index.column() == QuantityColumn) {
+        flags |= Qt::ItemIsEditable;
+    }
+    return flags;
+}
@@ -0,0 +1,47 @@
+#ifndef MENUMODEL_H
+#define MENUMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QVector>
+#include "databasemanager.h"
+
+// The student menu as a table model. Cells are produced on demand for the rows the view
+// paints, and a reload is one model reset over a shared copy of the product vector.
+class MenuModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        NameColumn,
+        ShopColumn,
+        PriceColumn,
+        QuantityColumn,
+        AddColumn,
+        ColumnCount
+    };
+
+    static const int MinQuantity = 1;
+    static const int MaxQuantity = 10;
+
+    explicit MenuModel(QObject *parent = nullptr);
+
+    void setProducts(const QVector<Product> &products);
+    const Product &product(int row) const;
+    int quantity(int row) const;
+    void setQuantity(int row, int quantity);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+private:
+    QVector<Product> products;
+    QHash<int, int> quantities;  // product id -> chosen quantity, only where it is not MinQuantity
+};
+
+#endif
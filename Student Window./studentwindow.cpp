@@ -1,9 +1,12 @@
 #include "studentwindow.h"
 #include "ui_studentwindow.h"
 #include "databasemanager.h"
+#include "startuptrace.h"
+#include "menumodel.h"
+#include "menudelegate.h"
+#include "cart.h"
 #include <QMessageBox>
 #include <QHeaderView>
-#include <QSpinBox>
 #include <QPushButton>
 #include <QHBoxLayout>
 #include <QWidget>
@@ -12,12 +15,45 @@
 #include <QDebug>
 #include <QDate>
 #include <QDateTime>
+#include <utility>
+
+namespace {
+
+const int kHistoryPageSize = 50;
+const int kSearchLimit = 200;
+
+void setStatus(QTableWidgetItem *item, const QString &status)
+{
+    item->setText(status);
+    // Color code status
+    if (status == "completed") {
+        item->setBackground(QColor(200, 255, 200));
+    } else if (status == "preparing") {
+        item->setBackground(QColor(255, 255, 200));
+    } else if (status == "pending") {
+        item->setBackground(QColor(255, 200, 200));
+    } else {
+        item->setBackground(QBrush());
+    }
+}
+
+QString cartText(const CartItem &item)
+{
+    return QString("%1 x %2 - ₹%3 (%4)")
+        .arg(item.quantity)
+        .arg(item.productName)
+        .arg(item.quantity * item.price, 0, 'f', 2)
+        .arg(item.shopName);
+}
+
+}
 
 StudentWindow::StudentWindow(int studentId, const QString &username, QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::studentwindow),
     studentId(studentId),
-    username(username)
+    username(username),
+    cart(new Cart(this))
 {
     ui->setupUi(this);
     setupUI();
@@ -34,9 +70,13 @@ void StudentWindow::setupUI()
     ui->welcomeLabel->setText("Welcome, " + username + "! Order food from CEG canteen");
 
     // Setup table properties
-    ui->productsTable->setColumnCount(5);
-    ui->productsTable->setHorizontalHeaderLabels({"Product", "Shop", "Price (₹)", "Quantity", "Add to Cart"});
+    menuModel = new MenuModel(this);
+    MenuDelegate *menuDelegate = new MenuDelegate(this);
+    ui->productsTable->setModel(menuModel);
+    ui->productsTable->setItemDelegate(menuDelegate);
     ui->productsTable->horizontalHeader()->setStretchLastSection(true);
+    // Fixed row heights, so the view never asks every row for a size hint
+    ui->productsTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
 
     ui->historyTable->setColumnCount(5);
     ui->historyTable->setHorizontalHeaderLabels({"Order ID", "Shop", "Total", "Status", "Date"});
@@ -46,8 +86,19 @@ void StudentWindow::setupUI()
     connect(ui->logoutButton, &QPushButton::clicked, this, &StudentWindow::on_logoutButton_clicked);
     connect(ui->placeOrderButton, &QPushButton::clicked, this, &StudentWindow::on_placeOrderButton_clicked);
     connect(ui->clearCartButton, &QPushButton::clicked, this, &StudentWindow::on_clearCartButton_clicked);
+    connect(ui->loadMoreHistoryButton, &QPushButton::clicked, this, &StudentWindow::onLoadMoreHistoryClicked);
+    connect(ui->searchEdit, &QLineEdit::textChanged, this, &StudentWindow::onSearchTextChanged);
+    connect(menuDelegate, &MenuDelegate::addToCartClicked, this, &StudentWindow::onAddToCartClicked);
+    connect(&DatabaseManager::instance(), &DatabaseManager::orderStatusChanged,
+            this, &StudentWindow::onOrderStatusChanged);
+    connect(cart, &Cart::itemAdded, this, &StudentWindow::onCartItemAdded);
+    connect(cart, &Cart::itemChanged, this, &StudentWindow::onCartItemChanged);
+    connect(cart, &Cart::itemRemoved, this, &StudentWindow::onCartItemRemoved);
+    connect(cart, &Cart::cleared, ui->cartList, &QListWidget::clear);
+    connect(cart, &Cart::totalChanged, this, &StudentWindow::onCartTotalChanged);
 
     // Load data
+    restoreCart();
     loadProducts();
     loadOrderHistory();
 }
@@ -57,14 +108,43 @@ void StudentWindow::loadProducts()
     loadProductsFromDatabase();
 }
 
+void StudentWindow::onSearchTextChanged()
+{
+    loadProducts();
+}
+
 void StudentWindow::loadProductsFromDatabase()
 {
-    // Clear existing data
-    ui->productsTable->setRowCount(0);
+    int generation = ++productsGeneration;
+    QString searchText = ui->searchEdit->text().trimmed();
+
+    if (!searchText.isEmpty()) {
+        // Each keystroke supersedes the previous search
+        DatabaseManager::instance().async(&DatabaseManager::searchProducts, searchText, kSearchLimit)
+            .then(this, [this, generation](const QVector<Product> &products) {
+                if (generation == productsGeneration) {
+                    showProducts(products);
+                }
+            });
+        return;
+    }
+
+    DatabaseManager::instance().async(&DatabaseManager::catalog)
+        .then(this, [this, generation](const CatalogSnapshot &catalog) {
+            // Drop results superseded by a newer reload
+            if (generation == productsGeneration) {
+                showProducts(catalog.products);
+            }
+        });
+}
 
-    auto products = DatabaseManager::instance().getAllAvailableProducts();
+void StudentWindow::showProducts(const QVector<Product> &products)
+{
+    // One model reset; rows are painted as they scroll into view
+    menuModel->setProducts(products);
 
-    if (products.isEmpty()) {
+    // No matches for a search just leaves the table empty
+    if (products.isEmpty() && ui->searchEdit->text().trimmed().isEmpty()) {
         QMessageBox msgBox;
         msgBox.setWindowTitle("No Products");
         msgBox.setText("No products available at the moment.");
@@ -74,148 +154,157 @@ void StudentWindow::loadProductsFromDatabase()
         return;
     }
 
-    for (int row = 0; row < products.size(); ++row) {
-        const auto& product = products[row];
-        ui->productsTable->insertRow(row);
-
-        int productId = product[0].toInt();
-        QString productName = product[1].toString();
-        QString shopName = product[2].toString();
-        double price = product[3].toDouble();
-        int shopId = product[6].toInt();
-
-        ui->productsTable->setItem(row, 0, new QTableWidgetItem(productName));
-        ui->productsTable->setItem(row, 1, new QTableWidgetItem(shopName));
-        ui->productsTable->setItem(row, 2, new QTableWidgetItem(QString("₹%1").arg(price, 0, 'f', 2)));
-
-        // Quantity spin box
-        QSpinBox *quantitySpin = new QSpinBox();
-        quantitySpin->setMinimum(1);
-        quantitySpin->setMaximum(10);
-        quantitySpin->setValue(1);
-        ui->productsTable->setCellWidget(row, 3, quantitySpin);
-
-        // Add to cart button
-        QPushButton *addButton = new QPushButton("Add to Cart");
-        addButton->setProperty("productId", productId);
-        addButton->setProperty("productName", productName);
-        addButton->setProperty("price", price);
-        addButton->setProperty("shopName", shopName);
-        addButton->setProperty("shopId", shopId);
-        addButton->setProperty("row", row);
-        addButton->setStyleSheet("background-color: #2196F3; color: white; padding: 4px;");
-        ui->productsTable->setCellWidget(row, 4, addButton);
-
-        connect(addButton, &QPushButton::clicked, this, &StudentWindow::onAddToCartClicked);
-    }
-
     qDebug() << "Loaded" << products.size() << "products from database";
+    StartupTrace::mark("student menu populated");
+}
+
+void StudentWindow::onAddToCartClicked(const QModelIndex &index)
+{
+    int row = index.row();
+    const Product &product = menuModel->product(row);
+    int quantity = menuModel->quantity(row);
+
+    cart->add(product, quantity);
+    cartSavesPending.insert(product.id);
+    saveCart();
+
+    // Reset quantity to 1
+    menuModel->setQuantity(row, MenuModel::MinQuantity);
+
+    // Show brief status message instead of dialog
+    statusBar()->showMessage(QString("Added %1 x %2 to cart!").arg(quantity).arg(product.name), 3000);
 }
 
-void StudentWindow::onAddToCartClicked()
+void StudentWindow::restoreCart()
 {
-    QPushButton *button = qobject_cast<QPushButton*>(sender());
-    if (!button) return;
-
-    int productId = button->property("productId").toInt();
-    QString productName = button->property("productName").toString();
-    double price = button->property("price").toDouble();
-    QString shopName = button->property("shopName").toString();
-    int shopId = button->property("shopId").toInt();
-    int row = button->property("row").toInt();
-
-    QSpinBox *spinBox = qobject_cast<QSpinBox*>(ui->productsTable->cellWidget(row, 3));
-    if (spinBox) {
-        int quantity = spinBox->value();
-
-        // Check if product already in cart
-        bool found = false;
-        for (auto& item : cartItems) {
-            if (item.productId == productId) {
-                item.quantity += quantity;
-                found = true;
-                break;
+    DatabaseManager::instance().async(&DatabaseManager::getSavedCart, studentId)
+        .then(this, [this](const QVector<SavedCartItem> &saved) {
+            // Lines added meanwhile are merged with the saved ones; a clear meanwhile discards them
+            if (!cartClearPending) {
+                for (const SavedCartItem &item : saved) {
+                    if (cart->contains(item.product.id)) {
+                        cartSavesPending.insert(item.product.id);
+                    }
+                    cart->add(item.product, item.quantity);
+                }
             }
-        }
+            cartRestored = true;
+            saveCart();
+        });
+}
 
-        if (!found) {
-            CartItem newItem;
-            newItem.productId = productId;
-            newItem.productName = productName;
-            newItem.shopName = shopName;
-            newItem.price = price;
-            newItem.quantity = quantity;
-            newItem.shopId = shopId;
-            cartItems.append(newItem);
-        }
+void StudentWindow::saveCart()
+{
+    // One write batch at a time, so saves for the same product never land out of order.
+    // Nothing is written until the saved cart is read, or it would be overwritten first.
+    if (!cartRestored || cartSaveRunning || (!cartClearPending && cartSavesPending.isEmpty())) {
+        return;
+    }
+
+    int student = studentId;
+    bool clear = std::exchange(cartClearPending, false);
+    QVector<QPair<int, int>> lines;  // product id, quantity (0 removes)
+    for (int productId : std::as_const(cartSavesPending)) {
+        lines.append(qMakePair(productId, cart->quantity(productId)));
+    }
+    cartSavesPending.clear();
+    cartSaveRunning = true;
 
-        // Update cart display
-        ui->cartList->clear();
-        for (const auto& item : cartItems) {
-            double totalPrice = item.quantity * item.price;
-            QString cartItem = QString("%1 x %2 - ₹%3 (%4)")
-                                   .arg(item.quantity)
-                                   .arg(item.productName)
-                                   .arg(totalPrice, 0, 'f', 2)
-                                   .arg(item.shopName);
-            ui->cartList->addItem(cartItem);
+    DatabaseManager::instance().runAsync([student, clear, lines]() {
+        DatabaseManager &db = DatabaseManager::instance();
+        if (clear) {
+            db.clearSavedCart(student);
         }
+        for (const auto &line : lines) {
+            db.saveCartItem(student, line.first, line.second);
+        }
+    }).then(this, [this]() {
+        cartSaveRunning = false;
+        saveCart();
+    });
+}
 
-        updateTotal();
+void StudentWindow::onCartItemAdded(int row)
+{
+    ui->cartList->insertItem(row, cartText(cart->item(row)));
+}
 
-        // Reset quantity to 1
-        spinBox->setValue(1);
+void StudentWindow::onCartItemChanged(int row)
+{
+    ui->cartList->item(row)->setText(cartText(cart->item(row)));
+}
 
-        // Show brief status message instead of dialog
-        statusBar()->showMessage(QString("Added %1 x %2 to cart!").arg(quantity).arg(productName), 3000);
-    }
+void StudentWindow::onCartItemRemoved(int row)
+{
+    delete ui->cartList->takeItem(row);
+}
+
+void StudentWindow::onCartTotalChanged(double total)
+{
+    ui->totalLabel->setText(QString("Total: ₹%1").arg(total, 0, 'f', 2));
 }
 
 void StudentWindow::loadOrderHistory()
 {
-    // Clear existing data
-    ui->historyTable->setRowCount(0);
+    historyCursor = OrderCursor();
+    fetchOrderHistoryPage(false);
+}
 
-    auto orders = DatabaseManager::instance().getOrdersByStudent(studentId);
+void StudentWindow::onLoadMoreHistoryClicked()
+{
+    fetchOrderHistoryPage(true);
+}
+
+void StudentWindow::fetchOrderHistoryPage(bool append)
+{
+    // Appending keeps the generation so a concurrent full reload still wins
+    int generation = append ? historyGeneration : ++historyGeneration;
+    ui->loadMoreHistoryButton->setEnabled(false);
+
+    DatabaseManager::instance().async(&DatabaseManager::getOrdersByStudentPage, studentId, historyCursor, kHistoryPageSize, true)
+        .then(this, [this, generation, append](const OrderPage &page) {
+            if (generation != historyGeneration) {
+                return;
+            }
+            historyCursor = page.next;
+            ui->loadMoreHistoryButton->setEnabled(page.hasMore);
+            showOrderHistory(page.orders, append);
+        });
+}
+
+void StudentWindow::showOrderHistory(const QVector<OrderSummary> &orders, bool append)
+{
+    // Clear existing data
+    if (!append) {
+        ui->historyTable->setRowCount(0);
+        historyStatusItems.clear();
+    }
 
     for (int i = 0; i < orders.size(); ++i) {
         const auto& order = orders[i];
         int row = ui->historyTable->rowCount();
         ui->historyTable->insertRow(row);
 
-        ui->historyTable->setItem(row, 0, new QTableWidgetItem(order[0].toString()));
-        ui->historyTable->setItem(row, 1, new QTableWidgetItem(order[1].toString()));
-        ui->historyTable->setItem(row, 2, new QTableWidgetItem(QString("₹%1").arg(order[2].toDouble(), 0, 'f', 2)));
-
-        QTableWidgetItem *statusItem = new QTableWidgetItem(order[3].toString());
-        // Color code status
-        if (order[3].toString() == "completed") {
-            statusItem->setBackground(QColor(200, 255, 200));
-        } else if (order[3].toString() == "preparing") {
-            statusItem->setBackground(QColor(255, 255, 200));
-        } else if (order[3].toString() == "pending") {
-            statusItem->setBackground(QColor(255, 200, 200));
-        }
+        ui->historyTable->setItem(row, 0, new QTableWidgetItem(QString::number(order.id)));
+        ui->historyTable->setItem(row, 1, new QTableWidgetItem(order.shopName));
+        ui->historyTable->setItem(row, 2, new QTableWidgetItem(QString("₹%1").arg(order.totalAmount, 0, 'f', 2)));
+
+        QTableWidgetItem *statusItem = new QTableWidgetItem;
+        setStatus(statusItem, order.status);
         ui->historyTable->setItem(row, 3, statusItem);
+        historyStatusItems.insert(order.id, statusItem);
 
-        ui->historyTable->setItem(row, 4, new QTableWidgetItem(order[4].toDateTime().toString("yyyy-MM-dd hh:mm")));
+        ui->historyTable->setItem(row, 4, new QTableWidgetItem(order.orderDate.toString("yyyy-MM-dd hh:mm")));
     }
 }
 
-void StudentWindow::updateTotal()
+void StudentWindow::onOrderStatusChanged(int orderId, const QString &status)
 {
-    double total = 0.0;
-    for (const auto& item : cartItems) {
-        total += item.quantity * item.price;
+    // Other students' orders and pages not loaded yet are not in the table
+    QTableWidgetItem *statusItem = historyStatusItems.value(orderId);
+    if (statusItem) {
+        setStatus(statusItem, status);
     }
-    ui->totalLabel->setText(QString("Total: ₹%1").arg(total, 0, 'f', 2));
-}
-
-void StudentWindow::clearCart()
-{
-    cartItems.clear();
-    ui->cartList->clear();
-    updateTotal();
 }
 
 void StudentWindow::on_logoutButton_clicked()
@@ -225,7 +314,7 @@ void StudentWindow::on_logoutButton_clicked()
 
 void StudentWindow::on_placeOrderButton_clicked()
 {
-    if (cartItems.isEmpty()) {
+    if (cart->isEmpty()) {
         QMessageBox msgBox;
         msgBox.setWindowTitle("Cart Empty");
         msgBox.setText("Your cart is empty! Add some items first.");
@@ -236,72 +325,71 @@ void StudentWindow::on_placeOrderButton_clicked()
     }
 
     // Check if all items are from the same shop
-    int firstShopId = cartItems[0].shopId;
-    for (const auto& item : cartItems) {
-        if (item.shopId != firstShopId) {
-            QMessageBox msgBox;
-            msgBox.setWindowTitle("Multiple Shops");
-            msgBox.setText("Please order from one shop at a time. Your cart contains items from multiple shops.");
-            msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-            msgBox.setIcon(QMessageBox::Warning);
-            msgBox.exec();
-            return;
-        }
-    }
-
-    // Calculate total
-    double total = 0.0;
-    for (const auto& item : cartItems) {
-        total += item.quantity * item.price;
-    }
-
-    // Create order in database
-    int orderId = DatabaseManager::instance().createOrder(studentId, firstShopId, total);
-    if (orderId == -1) {
+    if (cart->shopCount() > 1) {
         QMessageBox msgBox;
-        msgBox.setWindowTitle("Order Failed");
-        msgBox.setText("Failed to create order. Please try again.");
+        msgBox.setWindowTitle("Multiple Shops");
+        msgBox.setText("Please order from one shop at a time. Your cart contains items from multiple shops.");
         msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Critical);
+        msgBox.setIcon(QMessageBox::Warning);
         msgBox.exec();
         return;
     }
 
-    // Add order items
-    bool allItemsAdded = true;
-    for (const auto& item : cartItems) {
-        if (!DatabaseManager::instance().addOrderItem(orderId, item.productId, item.quantity, item.price)) {
-            allItemsAdded = false;
-        }
+    double total = cart->total();
+    QString shopName = cart->item(0).shopName;
+    QVector<OrderLine> orderLines;
+    orderLines.reserve(cart->size());
+    for (const auto& item : cart->lines()) {
+        orderLines.append({item.productId, item.shopId, item.quantity, item.price});
     }
 
-    if (allItemsAdded) {
-        QMessageBox msgBox;
-        msgBox.setWindowTitle("Order Placed");
-        msgBox.setText(QString("Order #%1 placed successfully!\nTotal Amount: ₹%2\nShop: %3")
-                           .arg(orderId)
-                           .arg(total, 0, 'f', 2)
-                           .arg(cartItems[0].shopName));
-        msgBox.setStyleSheet("QLabel{color: #2E7D32; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Information);
-        msgBox.exec();
+    // Order header and all items are written in a single transaction
+    ui->placeOrderButton->setEnabled(false);
+    ui->clearCartButton->setEnabled(false);
+    DatabaseManager::instance().async(&DatabaseManager::placeOrder, studentId, orderLines)
+        .then(this, [this, total, shopName, orderLines](int orderId) {
+            ui->placeOrderButton->setEnabled(true);
+            ui->clearCartButton->setEnabled(true);
+            if (orderId == -1) {
+                QMessageBox msgBox;
+                msgBox.setWindowTitle("Order Failed");
+                msgBox.setText("Failed to create order. Please try again.");
+                msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+                msgBox.setIcon(QMessageBox::Critical);
+                msgBox.exec();
+                return;
+            }
 
-        // Clear cart and reload history
-        clearCart();
-        loadOrderHistory();
-    } else {
-        QMessageBox msgBox;
-        msgBox.setWindowTitle("Order Partially Failed");
-        msgBox.setText("Order was placed but some items may not have been added correctly.");
-        msgBox.setStyleSheet("QLabel{color: #FF6F00; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Warning);
-        msgBox.exec();
-    }
+            // Only what was ordered leaves the cart; items added while the order ran stay
+            for (const OrderLine &line : orderLines) {
+                cart->setQuantity(line.productId, cart->quantity(line.productId) - line.quantity);
+            }
+
+            // placeOrder emptied the saved cart; clear it again behind any save still in flight
+            // and write back whatever is left
+            cartSavesPending.clear();
+            for (const auto& item : cart->lines()) {
+                cartSavesPending.insert(item.productId);
+            }
+            cartClearPending = true;
+            saveCart();
+            loadOrderHistory();
+
+            QMessageBox msgBox;
+            msgBox.setWindowTitle("Order Placed");
+            msgBox.setText(QString("Order #%1 placed successfully!\nTotal Amount: ₹%2\nShop: %3")
+                               .arg(orderId)
+                               .arg(total, 0, 'f', 2)
+                               .arg(shopName));
+            msgBox.setStyleSheet("QLabel{color: #2E7D32; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+            msgBox.setIcon(QMessageBox::Information);
+            msgBox.exec();
+        });
 }
 
 void StudentWindow::on_clearCartButton_clicked()
 {
-    if (cartItems.isEmpty()) {
+    if (cart->isEmpty()) {
         QMessageBox msgBox;
         msgBox.setWindowTitle("Cart Empty");
         msgBox.setText("Your cart is already empty!");
@@ -319,7 +407,10 @@ void StudentWindow::on_clearCartButton_clicked()
     msgBox.setIcon(QMessageBox::Question);
 
     if (msgBox.exec() == QMessageBox::Yes) {
-        clearCart();
+        cart->clear();
+        cartSavesPending.clear();
+        cartClearPending = true;
+        saveCart();
         statusBar()->showMessage("Your cart has been cleared!", 3000);
     }
 }
@@ -3,20 +3,19 @@
 
 #include <QMainWindow>
 #include <QSqlQuery>
+#include <QHash>
+#include <QSet>
+#include <QModelIndex>
+#include "databasemanager.h"
+
+class QTableWidgetItem;
+class MenuModel;
+class Cart;
 
 namespace Ui {
 class studentwindow;
 }
 
-struct CartItem {
-    int productId;
-    QString productName;
-    QString shopName;
-    double price;
-    int quantity;
-    int shopId;
-};
-
 class StudentWindow : public QMainWindow
 {
     Q_OBJECT
@@ -29,20 +28,39 @@ private slots:
     void on_logoutButton_clicked();
     void on_placeOrderButton_clicked();
     void on_clearCartButton_clicked();
-    void onAddToCartClicked();
+    void onAddToCartClicked(const QModelIndex &index);
+    void onLoadMoreHistoryClicked();
+    void onSearchTextChanged();
+    void onOrderStatusChanged(int orderId, const QString &status);
+    void onCartItemAdded(int row);
+    void onCartItemChanged(int row);
+    void onCartItemRemoved(int row);
+    void onCartTotalChanged(double total);
 
 private:
     Ui::studentwindow *ui;
     int studentId;
     QString username;
-    QVector<CartItem> cartItems;
+    Cart *cart;
+    MenuModel *menuModel;
+    int productsGeneration = 0;
+    int historyGeneration = 0;
+    OrderCursor historyCursor;
+    QHash<int, QTableWidgetItem*> historyStatusItems;  // order id -> Status cell
+    bool cartRestored = false;
+    bool cartSaveRunning = false;
+    bool cartClearPending = false;
+    QSet<int> cartSavesPending;  // product ids whose saved quantity is out of date
 
     void setupUI();
     void loadProducts();
     void loadProductsFromDatabase();
+    void showProducts(const QVector<Product> &products);
     void loadOrderHistory();
-    void updateTotal();
-    void clearCart();
+    void fetchOrderHistoryPage(bool append);
+    void showOrderHistory(const QVector<OrderSummary> &orders, bool append);
+    void restoreCart();
+    void saveCart();
 };
 
 #endif
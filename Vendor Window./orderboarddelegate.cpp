@@ -0,0 +1,93 @@
+#include "orderboarddelegate.h"
+#include "orderboardmodel.h"
+#include <QMouseEvent>
+#include <QPainter>
+
+namespace {
+
+bool canAccept(const QString &status)
+{
+    return status != "preparing" && status != "completed";
+}
+
+bool canComplete(const QString &status)
+{
+    return status != "completed";
+}
+
+void drawButton(QPainter *painter, const QRect &rect, const QString &text, const QColor &color, bool enabled)
+{
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(enabled ? color : QColor("#BDBDBD"));
+    painter->drawRoundedRect(rect, 3, 3);
+    painter->setPen(enabled ? QColor(Qt::white) : QColor("#757575"));
+    painter->drawText(rect, Qt::AlignCenter, text);
+}
+
+}
+
+OrderBoardDelegate::OrderBoardDelegate(QObject *parent) :
+    QStyledItemDelegate(parent)
+{
+}
+
+QRect OrderBoardDelegate::acceptRect(const QRect &cell)
+{
+    QRect inner = cell.adjusted(2, 2, -2, -2);
+    inner.setWidth((inner.width() - 4) / 2);
+    return inner;
+}
+
+QRect OrderBoardDelegate::completeRect(const QRect &cell)
+{
+    QRect inner = cell.adjusted(2, 2, -2, -2);
+    inner.setLeft(acceptRect(cell).right() + 5);
+    return inner;
+}
+
+void OrderBoardDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if (index.column() != OrderBoardModel::ActionsColumn) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    // Same colours as the per-row QPushButtons these replace
+    QString status = index.data(OrderBoardModel::StatusRole).toString();
+    bool pending = index.data(OrderBoardModel::PendingRole).toBool();
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    drawButton(painter, acceptRect(option.rect), "Accept", QColor("#4CAF50"), !pending && canAccept(status));
+    drawButton(painter, completeRect(option.rect), "Complete", QColor("#2196F3"), !pending && canComplete(status));
+    painter->restore();
+}
+
+bool OrderBoardDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                                     const QModelIndex &index)
+{
+    if (event->type() != QEvent::MouseButtonRelease || index.column() != OrderBoardModel::ActionsColumn) {
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+    QMouseEvent *mouse = static_cast<QMouseEvent*>(event);
+    if (mouse->button() != Qt::LeftButton) {
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+
+    QPoint position = mouse->position().toPoint();
+    int orderId = index.data(OrderBoardModel::OrderIdRole).toInt();
+    QString status = index.data(OrderBoardModel::StatusRole).toString();
+    bool pending = index.data(OrderBoardModel::PendingRole).toBool();
+    if (acceptRect(option.rect).contains(position)) {
+        if (!pending && canAccept(status)) {
+            emit acceptClicked(orderId);
+        }
+        return true;
+    }
+    if (completeRect(option.rect).contains(position)) {
+        if (!pending && canComplete(status)) {
+            emit completeClicked(orderId);
+        }
+        return true;
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
@@ -0,0 +1,31 @@
+#ifndef ORDERBOARDDELEGATE_H
+#define ORDERBOARDDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// Paints the Accept and Complete buttons of OrderBoardModel rows instead of creating a
+// widget per row. Which button is enabled follows the row's status and pending flag, so a
+// change to either only needs the model's dataChanged to repaint.
+class OrderBoardDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit OrderBoardDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+signals:
+    void acceptClicked(int orderId);
+    void completeClicked(int orderId);
+
+protected:
+    bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                     const QModelIndex &index) override;
+
+private:
+    static QRect acceptRect(const QRect &cell);
+    static QRect completeRect(const QRect &cell);
+};
+
+#endif
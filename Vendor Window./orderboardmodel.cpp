@@ -0,0 +1,183 @@
+#include "orderboardmodel.h"
+
+OrderBoardModel::OrderBoardModel(QObject *parent) :
+    QAbstractTableModel(parent)
+{
+}
+
+void OrderBoardModel::clear()
+{
+    setOrders({});
+}
+
+void OrderBoardModel::setOrders(const QVector<OrderSummary> &orders)
+{
+    beginResetModel();
+    top.clear();
+    bottom.clear();
+    slots.clear();
+    appendOrders(orders);
+    endResetModel();
+}
+
+void OrderBoardModel::appendOrders(const QVector<OrderSummary> &orders)
+{
+    QVector<OrderSummary> added;
+    added.reserve(orders.size());
+    for (const OrderSummary &order : orders) {
+        // A poll may already have placed this order at the top
+        if (!slots.contains(order.id)) {
+            added.append(order);
+        }
+    }
+    if (added.isEmpty()) {
+        return;
+    }
+
+    int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + int(added.size()) - 1);
+    for (const OrderSummary &order : added) {
+        slots.insert(order.id, int(bottom.size()));
+        bottom.append(order);
+    }
+    endInsertRows();
+}
+
+void OrderBoardModel::prependOrder(const OrderSummary &order)
+{
+    if (updateOrder(order)) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), 0, 0);
+    top.append(order);
+    slots.insert(order.id, -int(top.size()));
+    endInsertRows();
+}
+
+bool OrderBoardModel::updateOrder(const OrderSummary &order)
+{
+    auto it = slots.constFind(order.id);
+    if (it == slots.constEnd()) {
+        return false;
+    }
+    int slot = it.value();
+    (slot >= 0 ? bottom[slot] : top[-slot - 1]) = order;
+    rowChanged(slot);
+    return true;
+}
+
+bool OrderBoardModel::setStatus(int orderId, const QString &status)
+{
+    auto it = slots.constFind(orderId);
+    if (it == slots.constEnd()) {
+        return false;
+    }
+    int slot = it.value();
+    (slot >= 0 ? bottom[slot] : top[-slot - 1]).status = status;
+    rowChanged(slot);
+    return true;
+}
+
+void OrderBoardModel::setPending(int orderId, bool isPending)
+{
+    if (isPending) {
+        pending.insert(orderId);
+    } else {
+        pending.remove(orderId);
+    }
+    auto it = slots.constFind(orderId);
+    if (it != slots.constEnd()) {
+        rowChanged(it.value());
+    }
+}
+
+bool OrderBoardModel::contains(int orderId) const
+{
+    return slots.contains(orderId);
+}
+
+int OrderBoardModel::rowOf(int slot) const
+{
+    // top[k] sits at row top.size() - 1 - k, so both halves map the same way
+    return int(top.size()) + slot;
+}
+
+void OrderBoardModel::rowChanged(int slot)
+{
+    int row = rowOf(slot);
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+}
+
+const OrderSummary &OrderBoardModel::orderAt(int row) const
+{
+    int topRows = int(top.size());
+    return row < topRows ? top[topRows - 1 - row] : bottom[row - topRows];
+}
+
+int OrderBoardModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(top.size() + bottom.size());
+}
+
+int OrderBoardModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant OrderBoardModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    const OrderSummary &order = orderAt(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case IdColumn:
+            return QString::number(order.id);
+        case CustomerColumn:
+            return order.customer;
+        case ItemsColumn:
+            return order.items;
+        case TotalColumn:
+            return QString("₹%1").arg(order.totalAmount, 0, 'f', 2);
+        case StatusColumn:
+            return order.status;
+        case TimeColumn:
+            return order.orderDate.toString("hh:mm AP");
+        }
+        break;
+    case OrderIdRole:
+        return order.id;
+    case StatusRole:
+        return order.status;
+    case PendingRole:
+        return pending.contains(order.id);
+    }
+    return QVariant();
+}
+
+QVariant OrderBoardModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case IdColumn:
+        return QString("Order ID");
+    case CustomerColumn:
+        return QString("Customer");
+    case ItemsColumn:
+        return QString("Items");
+    case TotalColumn:
+        return QString("Total (₹)");
+    case StatusColumn:
+        return QString("Status");
+    case TimeColumn:
+        return QString("Order Time");
+    case ActionsColumn:
+        return QString("Actions");
+    }
+    return QVariant();
+}
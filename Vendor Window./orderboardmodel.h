@@ -0,0 +1,67 @@
+#ifndef ORDERBOARDMODEL_H
+#define ORDERBOARDMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include "databasemanager.h"
+
+// The vendor's order board, newest first, keyed by order id. A status change touches one
+// row and emits dataChanged for it alone. New orders go on top and older pages at the
+// bottom without renumbering the rows already on the board.
+class OrderBoardModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        IdColumn,
+        CustomerColumn,
+        ItemsColumn,
+        TotalColumn,
+        StatusColumn,
+        TimeColumn,
+        ActionsColumn,
+        ColumnCount
+    };
+
+    enum Role {
+        OrderIdRole = Qt::UserRole + 1,
+        StatusRole,
+        PendingRole
+    };
+
+    explicit OrderBoardModel(QObject *parent = nullptr);
+
+    void clear();
+    void setOrders(const QVector<OrderSummary> &orders);
+    // Older orders below the board; ids already on it are skipped
+    void appendOrders(const QVector<OrderSummary> &orders);
+    void prependOrder(const OrderSummary &order);
+    // Both return false if the order is not on the board
+    bool updateOrder(const OrderSummary &order);
+    bool setStatus(int orderId, const QString &status);
+    // A pending order's buttons are disabled until its status update comes back; kept across reloads
+    void setPending(int orderId, bool pending);
+    bool contains(int orderId) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    const OrderSummary &orderAt(int row) const;
+    int rowOf(int slot) const;
+    void rowChanged(int slot);
+
+    // Rows are top (prepended, last element is row 0) followed by bottom (pages, in order)
+    QVector<OrderSummary> top;
+    QVector<OrderSummary> bottom;
+    // order id -> slot: i >= 0 is bottom[i], i < 0 is top[-i - 1]; slots never move
+    QHash<int, int> slots;
+    QSet<int> pending;
+};
+
+#endif
@@ -1,20 +1,37 @@
 #include "vendorwindow.h"
 #include "ui_vendorwindow.h"
 #include "databasemanager.h"
+#include "startuptrace.h"
+#include "orderboardmodel.h"
+#include "orderboarddelegate.h"
 #include <QMessageBox>
 #include <QHeaderView>
 #include <QPushButton>
-#include <QHBoxLayout>
 #include <QWidget>
 #include <QDebug>
 #include <QDateTime>
+#include <QTimer>
+#include <QFileDialog>
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QPointer>
+
+namespace {
+
+const int kOrdersPageSize = 50;
+const int kPaymentsPageSize = 10;
+const int kChangePollIntervalMs = 1000;
+
+}
 
 VendorWindow::VendorWindow(int vendorId, const QString &username, QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::vendorwindow),
     vendorId(vendorId),
     username(username),
-    shopId(-1)
+    shopId(-1),
+    changePollTimer(new QTimer(this)),
+    orderBoard(new OrderBoardModel(this))
 {
     ui->setupUi(this);
     setupUI();
@@ -32,28 +49,56 @@ void VendorWindow::setupUI()
 
     // Setup table properties
     ui->productsTable->horizontalHeader()->setStretchLastSection(true);
+    OrderBoardDelegate *orderBoardDelegate = new OrderBoardDelegate(this);
+    ui->ordersTable->setModel(orderBoard);
+    ui->ordersTable->setItemDelegate(orderBoardDelegate);
     ui->ordersTable->horizontalHeader()->setStretchLastSection(true);
+    // Fixed row heights, so the view never asks every row for a size hint
+    ui->ordersTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     ui->paymentHistoryTable->horizontalHeader()->setStretchLastSection(true);
+    ui->exportMonthEdit->setDate(QDate::currentDate());
 
     // Connect signals
     connect(ui->logoutButton, &QPushButton::clicked, this, &VendorWindow::on_logoutButton_clicked);
     connect(ui->registerShopButton, &QPushButton::clicked, this, &VendorWindow::on_registerShopButton_clicked);
     connect(ui->addProductButton, &QPushButton::clicked, this, &VendorWindow::on_addProductButton_clicked);
-
-    // Check if shop already registered
+    connect(ui->importProductsButton, &QPushButton::clicked, this, &VendorWindow::onImportProductsClicked);
+    connect(ui->exportOrdersButton, &QPushButton::clicked, this, &VendorWindow::onExportOrdersClicked);
+    connect(ui->loadMoreOrdersButton, &QPushButton::clicked, this, &VendorWindow::onLoadMoreOrdersClicked);
+    connect(ui->loadMorePaymentsButton, &QPushButton::clicked, this, &VendorWindow::onLoadMorePaymentsClicked);
+    connect(orderBoardDelegate, &OrderBoardDelegate::acceptClicked, this, &VendorWindow::onAcceptOrderClicked);
+    connect(orderBoardDelegate, &OrderBoardDelegate::completeClicked, this, &VendorWindow::onCompleteOrderClicked);
+
+    // Pick up new and changed orders without reloading the board
+    changePollTimer->setInterval(kChangePollIntervalMs);
+    connect(changePollTimer, &QTimer::timeout, this, &VendorWindow::pollOrderChanges);
+
+    // Check if shop already registered, then load initial data
     checkShopRegistration();
-
-    // Load initial data
-    loadMyProducts();
-    loadOrders();
-    loadFinancialData();
 }
 
 void VendorWindow::checkShopRegistration()
 {
-    shopId = DatabaseManager::instance().getShopId(vendorId);
+    // Registering is held back until the lookup says there is no shop yet
+    int vendor = vendorId;
+    ui->registerShopButton->setEnabled(false);
+    DatabaseManager::instance().runAsync([vendor]() {
+        DatabaseManager &db = DatabaseManager::instance();
+        int shop = db.getShopId(vendor);
+        return qMakePair(shop, shop == -1 ? QString() : db.getShopName(shop));
+    }).then(this, [this](const QPair<int, QString> &shop) {
+        shopId = shop.first;
+        showShop(shop.second);
+
+        loadMyProducts();
+        loadOrders();
+        loadFinancialData();
+    });
+}
+
+void VendorWindow::showShop(const QString &shopName)
+{
     if (shopId != -1) {
-        QString shopName = DatabaseManager::instance().getShopName(shopId);
         ui->shopStatusLabel->setText("Shop Registered: " + shopName);
         ui->shopStatusLabel->setStyleSheet("color: #4CAF50; font-weight: bold; padding: 10px;");
         ui->shopNameEdit->setEnabled(false);
@@ -63,6 +108,7 @@ void VendorWindow::checkShopRegistration()
     } else {
         ui->shopStatusLabel->setText("No shop registered");
         ui->shopStatusLabel->setStyleSheet("color: #f44336; font-weight: bold; padding: 10px;");
+        ui->registerShopButton->setEnabled(true);
     }
 }
 
@@ -81,29 +127,41 @@ void VendorWindow::on_registerShopButton_clicked()
     QString slotNumber = ui->slotEdit->text().trimmed().toUpper();
     QString description = ui->descriptionEdit->toPlainText().trimmed();
 
-    if (DatabaseManager::instance().registerShop(vendorId, shopName, slotNumber, description)) {
-        QMessageBox msgBox;
-        msgBox.setWindowTitle("Success");
-        msgBox.setText(QString("Shop '%1' registered successfully at slot %2!").arg(shopName).arg(slotNumber));
-        msgBox.setStyleSheet("QLabel{color: #2E7D32; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Information);
-        msgBox.exec();
-
-        // Update UI
-        checkShopRegistration();
-
-        // Clear form
-        ui->shopNameEdit->clear();
-        ui->slotEdit->clear();
-        ui->descriptionEdit->clear();
-    } else {
-        QMessageBox msgBox;
-        msgBox.setWindowTitle("Registration Failed");
-        msgBox.setText("Failed to register shop. Please try again.");
-        msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Critical);
-        msgBox.exec();
-    }
+    // The new shop's id and name come back with the result, so nothing blocks the GUI thread
+    int vendor = vendorId;
+    ui->registerShopButton->setEnabled(false);
+    DatabaseManager::instance().runAsync([vendor, shopName, slotNumber, description]() {
+        DatabaseManager &db = DatabaseManager::instance();
+        int shop = db.registerShop(vendor, shopName, slotNumber, description) ? db.getShopId(vendor) : -1;
+        return qMakePair(shop, shop == -1 ? QString() : db.getShopName(shop));
+    }).then(this, [this, shopName, slotNumber](const QPair<int, QString> &shop) {
+        if (shop.first != -1) {
+            QMessageBox msgBox;
+            msgBox.setWindowTitle("Success");
+            msgBox.setText(QString("Shop '%1' registered successfully at slot %2!").arg(shopName).arg(slotNumber));
+            msgBox.setStyleSheet("QLabel{color: #2E7D32; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+            msgBox.setIcon(QMessageBox::Information);
+            msgBox.exec();
+
+            // Update UI
+            shopId = shop.first;
+            showShop(shop.second);
+            loadOrders();
+
+            // Clear form
+            ui->shopNameEdit->clear();
+            ui->slotEdit->clear();
+            ui->descriptionEdit->clear();
+        } else {
+            ui->registerShopButton->setEnabled(true);
+            QMessageBox msgBox;
+            msgBox.setWindowTitle("Registration Failed");
+            msgBox.setText("Failed to register shop. Please try again.");
+            msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+            msgBox.setIcon(QMessageBox::Critical);
+            msgBox.exec();
+        }
+    });
 }
 
 void VendorWindow::on_addProductButton_clicked()
@@ -126,92 +184,220 @@ void VendorWindow::on_addProductButton_clicked()
     double price = ui->priceEdit->text().toDouble();
     QString category = ui->categoryEdit->text().trimmed();
 
-    if (DatabaseManager::instance().addProduct(shopId, productName, price, category)) {
-        // Reload products
-        loadMyProducts();
-
-        // Clear form
-        ui->productNameEdit->clear();
-        ui->priceEdit->clear();
-        ui->categoryEdit->clear();
+    ui->addProductButton->setEnabled(false);
+    DatabaseManager::instance().async(&DatabaseManager::addProduct, shopId, productName, price, category)
+        .then(this, [this](bool added) {
+            ui->addProductButton->setEnabled(true);
+            if (added) {
+                // Reload products
+                loadMyProducts();
+
+                // Clear form
+                ui->productNameEdit->clear();
+                ui->priceEdit->clear();
+                ui->categoryEdit->clear();
+
+                statusBar()->showMessage("Product added successfully!", 3000);
+            } else {
+                QMessageBox msgBox;
+                msgBox.setWindowTitle("Error");
+                msgBox.setText("Failed to add product. Please try again.");
+                msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+                msgBox.setIcon(QMessageBox::Critical);
+                msgBox.exec();
+            }
+        });
+}
 
-        statusBar()->showMessage("Product added successfully!", 3000);
-    } else {
+void VendorWindow::onImportProductsClicked()
+{
+    if (shopId == -1) {
         QMessageBox msgBox;
-        msgBox.setWindowTitle("Error");
-        msgBox.setText("Failed to add product. Please try again.");
+        msgBox.setWindowTitle("No Shop");
+        msgBox.setText("Please register a shop first before importing products.");
         msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Critical);
+        msgBox.setIcon(QMessageBox::Warning);
         msgBox.exec();
+        return;
     }
-}
 
-void VendorWindow::onRemoveProductClicked()
-{
-    QPushButton *button = qobject_cast<QPushButton*>(sender());
-    if (!button) return;
+    QString filePath = QFileDialog::getOpenFileName(this, "Import Products", QString(),
+                                                    "CSV files (*.csv);;All files (*)");
+    if (filePath.isEmpty()) {
+        return;
+    }
 
-    int productId = button->property("productId").toInt();
-    int row = button->property("row").toInt();
+    // The import runs on the database worker pool; the dialog only tracks it
+    ui->importProductsButton->setEnabled(false);
+    QProgressDialog *progress = new QProgressDialog("Importing products...", "Cancel", 0, 1000, this);
+    progress->setWindowTitle("Import Products");
+    progress->setMinimumDuration(500);
+    QFutureWatcher<ProductImportResult> *watcher = new QFutureWatcher<ProductImportResult>(this);
+    auto summary = std::make_shared<ProductImportResult>();
+
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcherBase::cancel);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, progress, summary]() {
+        ui->importProductsButton->setEnabled(true);
+        progress->deleteLater();
+        watcher->deleteLater();
+        loadMyProducts();
+
+        // A canceled future drops its result; the summary still has it, and stays empty if the
+        // import was canceled before it started
+        ProductImportResult result = watcher->future().resultCount() > 0 ? watcher->result() : *summary;
+        result.canceled = result.canceled || watcher->isCanceled();
+        QString text = QString("Imported %1 products, rejected %2 rows.").arg(result.imported).arg(result.rejected);
+        if (result.failed) {
+            text.prepend("Import stopped by an error. ");
+        } else if (result.canceled) {
+            text.prepend("Import canceled; products imported before the cancel were kept. ");
+        }
+        for (int i = 0; i < qMin(10, int(result.errors.size())); ++i) {
+            text += QString("\nLine %1: %2").arg(result.errors[i].line).arg(result.errors[i].message);
+        }
 
-    if (DatabaseManager::instance().updateProductAvailability(productId, false)) {
-        ui->productsTable->removeRow(row);
-        statusBar()->showMessage("Product removed!", 3000);
-    } else {
         QMessageBox msgBox;
-        msgBox.setWindowTitle("Error");
-        msgBox.setText("Failed to remove product.");
-        msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Critical);
+        msgBox.setWindowTitle("Import Products");
+        msgBox.setText(text);
+        if (result.failed || result.canceled || result.rejected > 0) {
+            msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+            msgBox.setIcon(QMessageBox::Warning);
+        } else {
+            msgBox.setStyleSheet("QLabel{color: #2E7D32; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+            msgBox.setIcon(QMessageBox::Information);
+        }
         msgBox.exec();
-    }
+    });
+
+    watcher->setFuture(DatabaseManager::instance().importProductsAsync(shopId, filePath, summary));
 }
 
-void VendorWindow::onAcceptOrderClicked()
+void VendorWindow::onExportOrdersClicked()
 {
-    QPushButton *button = qobject_cast<QPushButton*>(sender());
-    if (!button) return;
-
-    int orderId = button->property("orderId").toInt();
-    int row = button->property("row").toInt();
-
-    if (DatabaseManager::instance().updateOrderStatus(orderId, "preparing")) {
-        ui->ordersTable->item(row, 4)->setText("Preparing");
-        button->setEnabled(false);
-        statusBar()->showMessage("Order accepted and now being prepared!", 3000);
-        loadOrders(); // Reload to update statistics
-    } else {
+    if (shopId == -1) {
         QMessageBox msgBox;
-        msgBox.setWindowTitle("Error");
-        msgBox.setText("Failed to update order status.");
+        msgBox.setWindowTitle("No Shop");
+        msgBox.setText("Please register a shop first before exporting orders.");
         msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Critical);
+        msgBox.setIcon(QMessageBox::Warning);
         msgBox.exec();
+        return;
+    }
+
+    QDate month = ui->exportMonthEdit->date();
+    QString csvFilter = "CSV files (*.csv)";
+    QString jsonFilter = "JSON Lines files (*.jsonl)";
+    QString selectedFilter = csvFilter;
+    QString filePath = QFileDialog::getSaveFileName(this, "Export Orders",
+                                                    QString("orders-%1.csv").arg(month.toString("yyyy-MM")),
+                                                    csvFilter + ";;" + jsonFilter, &selectedFilter);
+    if (filePath.isEmpty()) {
+        return;
     }
+    ExportFormat format = (selectedFilter == jsonFilter || filePath.endsWith(".jsonl", Qt::CaseInsensitive))
+                              ? ExportFormat::JsonLines
+                              : ExportFormat::Csv;
+
+    ui->exportOrdersButton->setEnabled(false);
+    QProgressDialog *progress = new QProgressDialog("Exporting orders...", "Cancel", 0, 0, this);
+    progress->setWindowTitle("Export Orders");
+    progress->setMinimumDuration(500);
+    QFutureWatcher<OrderExportResult> *watcher = new QFutureWatcher<OrderExportResult>(this);
+
+    connect(watcher, &QFutureWatcherBase::progressRangeChanged, progress, &QProgressDialog::setRange);
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcherBase::cancel);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, progress, filePath]() {
+        ui->exportOrdersButton->setEnabled(true);
+        progress->deleteLater();
+        watcher->deleteLater();
+
+        if (watcher->future().resultCount() == 0) {
+            statusBar()->showMessage("Order export canceled", 3000);
+            return;
+        }
+
+        OrderExportResult result = watcher->result();
+        if (result.failed) {
+            QMessageBox msgBox;
+            msgBox.setWindowTitle("Export Failed");
+            msgBox.setText(result.error);
+            msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+            msgBox.setIcon(QMessageBox::Critical);
+            msgBox.exec();
+            return;
+        }
+        statusBar()->showMessage(QString("Exported %1 orders to %2").arg(result.rows).arg(filePath), 5000);
+    });
+
+    watcher->setFuture(DatabaseManager::instance().exportOrdersAsync(shopId, month, format, filePath));
 }
 
-void VendorWindow::onCompleteOrderClicked()
+void VendorWindow::onRemoveProductClicked()
 {
     QPushButton *button = qobject_cast<QPushButton*>(sender());
     if (!button) return;
 
-    int orderId = button->property("orderId").toInt();
-    int row = button->property("row").toInt();
+    int productId = button->property("productId").toInt();
 
-    if (DatabaseManager::instance().updateOrderStatus(orderId, "completed")) {
-        ui->ordersTable->item(row, 4)->setText("Completed");
-        button->setEnabled(false);
-        statusBar()->showMessage("Order marked as completed!", 3000);
-        loadOrders(); // Reload to update statistics
-        loadFinancialData(); // Reload financial data
-    } else {
-        QMessageBox msgBox;
-        msgBox.setWindowTitle("Error");
-        msgBox.setText("Failed to update order status.");
-        msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
-        msgBox.setIcon(QMessageBox::Critical);
-        msgBox.exec();
-    }
+    // Rows may be removed or reloaded while the update runs, so the row is found again afterwards
+    QPointer<QPushButton> removeButton = button;
+    button->setEnabled(false);
+    DatabaseManager::instance().async(&DatabaseManager::updateProductAvailability, productId, false)
+        .then(this, [this, removeButton](bool removed) {
+            if (removed) {
+                for (int row = 0; removeButton && row < ui->productsTable->rowCount(); ++row) {
+                    if (ui->productsTable->cellWidget(row, 4) == removeButton) {
+                        ui->productsTable->removeRow(row);
+                        break;
+                    }
+                }
+                statusBar()->showMessage("Product removed!", 3000);
+            } else {
+                if (removeButton) {
+                    removeButton->setEnabled(true);
+                }
+                QMessageBox msgBox;
+                msgBox.setWindowTitle("Error");
+                msgBox.setText("Failed to remove product.");
+                msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+                msgBox.setIcon(QMessageBox::Critical);
+                msgBox.exec();
+            }
+        });
+}
+
+void VendorWindow::onAcceptOrderClicked(int orderId)
+{
+    setOrderStatus(orderId, "preparing", "Order accepted and now being prepared!");
+}
+
+void VendorWindow::onCompleteOrderClicked(int orderId)
+{
+    setOrderStatus(orderId, "completed", "Order marked as completed!");
+}
+
+void VendorWindow::setOrderStatus(int orderId, const QString &status, const QString &message)
+{
+    // The row's buttons stay disabled until the update comes back
+    orderBoard->setPending(orderId, true);
+    DatabaseManager::instance().async(&DatabaseManager::updateOrderStatus, orderId, status)
+        .then(this, [this, orderId, status, message](bool updated) {
+            orderBoard->setPending(orderId, false);
+            if (updated) {
+                orderBoard->setStatus(orderId, status);
+                statusBar()->showMessage(message, 3000);
+                pollOrderChanges(); // Refresh statistics and financial data
+            } else {
+                QMessageBox msgBox;
+                msgBox.setWindowTitle("Error");
+                msgBox.setText("Failed to update order status.");
+                msgBox.setStyleSheet("QLabel{color: #B71C1C; font-weight: bold;} QPushButton{ padding: 5px 10px; }");
+                msgBox.setIcon(QMessageBox::Critical);
+                msgBox.exec();
+            }
+        });
 }
 
 bool VendorWindow::validateShopRegistration()
@@ -278,25 +464,36 @@ bool VendorWindow::validateProductInput()
 
 void VendorWindow::loadMyProducts()
 {
-    // Clear existing data
-    ui->productsTable->setRowCount(0);
-
+    int generation = ++productsGeneration;
     if (shopId == -1) {
+        ui->productsTable->setRowCount(0);
         return;
     }
 
-    auto products = DatabaseManager::instance().getProductsByShop(shopId);
+    DatabaseManager::instance().async(&DatabaseManager::getProductsByShop, shopId)
+        .then(this, [this, generation](const QVector<Product> &products) {
+            // Drop results superseded by a newer reload
+            if (generation == productsGeneration) {
+                showMyProducts(products);
+            }
+        });
+}
+
+void VendorWindow::showMyProducts(const QVector<Product> &products)
+{
+    // Clear existing data
+    ui->productsTable->setRowCount(0);
 
     for (int i = 0; i < products.size(); ++i) {
         const auto& product = products[i];
         int row = ui->productsTable->rowCount();
         ui->productsTable->insertRow(row);
 
-        int productId = product[0].toInt();
-        QString productName = product[1].toString();
-        double price = product[2].toDouble();
-        QString category = product[3].toString();
-        bool available = product[4].toBool();
+        int productId = product.id;
+        QString productName = product.name;
+        double price = product.price;
+        QString category = product.category;
+        bool available = product.available;
 
         ui->productsTable->setItem(row, 0, new QTableWidgetItem(productName));
         ui->productsTable->setItem(row, 1, new QTableWidgetItem(QString("₹%1").arg(price, 0, 'f', 2)));
@@ -306,7 +503,6 @@ void VendorWindow::loadMyProducts()
         // Remove button
         QPushButton *removeButton = new QPushButton("Remove");
         removeButton->setProperty("productId", productId);
-        removeButton->setProperty("row", row);
         removeButton->setStyleSheet("background-color: #f44336; color: white; padding: 4px;");
         ui->productsTable->setCellWidget(row, 4, removeButton);
 
@@ -316,80 +512,119 @@ void VendorWindow::loadMyProducts()
 
 void VendorWindow::loadOrders()
 {
-    // Clear existing data
-    ui->ordersTable->setRowCount(0);
-
     if (shopId == -1) {
+        orderBoard->clear();
+        ui->loadMoreOrdersButton->setEnabled(false);
+        return;
+    }
+
+    ordersCursor = OrderCursor();
+    fetchOrdersPage(false);
+}
+
+void VendorWindow::onLoadMoreOrdersClicked()
+{
+    fetchOrdersPage(true);
+}
+
+void VendorWindow::fetchOrdersPage(bool append)
+{
+    int shop = shopId;
+    OrderCursor cursor = ordersCursor;
+    // Appending keeps the generation so a concurrent full reload still wins
+    int generation = append ? ordersGeneration : ++ordersGeneration;
+    ui->loadMoreOrdersButton->setEnabled(false);
+
+    DatabaseManager::instance().runAsync([shop, cursor, append]() {
+        DatabaseManager &db = DatabaseManager::instance();
+        ShopSnapshot snapshot;
+        // Read the sequence first so changes racing with the page are replayed, not lost
+        if (!append) {
+            snapshot.changeSeq = db.getOrderChangeSequence();
+        }
+        snapshot.stats = db.getShopStats(shop);
+        snapshot.page = db.getOrdersByShopPage(shop, cursor, kOrdersPageSize);
+        return snapshot;
+    }).then(this, [this, generation, append](const ShopSnapshot &snapshot) {
+        // Drop results superseded by a newer reload
+        if (generation != ordersGeneration) {
+            return;
+        }
+        if (!append) {
+            ordersChangeSeq = snapshot.changeSeq;
+            newestOrderId = snapshot.page.orders.isEmpty() ? 0 : snapshot.page.orders.first().id;
+            changePollTimer->start();
+        }
+        ordersCursor = snapshot.page.next;
+        ui->loadMoreOrdersButton->setEnabled(snapshot.page.hasMore);
+        if (append) {
+            orderBoard->appendOrders(snapshot.page.orders);
+        } else {
+            orderBoard->setOrders(snapshot.page.orders);
+        }
+        StartupTrace::mark("vendor orders populated");
+
+        // Update order statistics
+        ui->pendingOrdersLabel->setText(QString("Pending: %1").arg(snapshot.stats.pendingOrders));
+        ui->preparingOrdersLabel->setText(QString("Preparing: %1").arg(snapshot.stats.preparingOrders));
+        ui->readyOrdersLabel->setText(QString("Completed: %1").arg(snapshot.stats.completedOrders));
+    });
+}
+
+void VendorWindow::pollOrderChanges()
+{
+    if (shopId == -1 || changePollPending) {
         return;
     }
 
-    auto orders = DatabaseManager::instance().getOrdersByShop(shopId);
-
-    int pendingCount = 0, preparingCount = 0, completedCount = 0;
-
-    for (int i = 0; i < orders.size(); ++i) {
-        const auto& order = orders[i];
-        int row = ui->ordersTable->rowCount();
-        ui->ordersTable->insertRow(row);
-
-        int orderId = order[0].toInt();
-        QString customer = order[1].toString();
-        double total = order[2].toDouble();
-        QString status = order[3].toString();
-        QDateTime orderDateTime = order[4].toDateTime();
-        QString orderDate = orderDateTime.toString("hh:mm AP");
-        QString items = order[5].toString();
-
-        // Count status
-        if (status == "pending") pendingCount++;
-        else if (status == "preparing") preparingCount++;
-        else if (status == "completed") completedCount++;
-
-        ui->ordersTable->setItem(row, 0, new QTableWidgetItem(QString::number(orderId)));
-        ui->ordersTable->setItem(row, 1, new QTableWidgetItem(customer));
-        ui->ordersTable->setItem(row, 2, new QTableWidgetItem(items));
-        ui->ordersTable->setItem(row, 3, new QTableWidgetItem(QString("₹%1").arg(total, 0, 'f', 2)));
-        ui->ordersTable->setItem(row, 4, new QTableWidgetItem(status));
-        ui->ordersTable->setItem(row, 5, new QTableWidgetItem(orderDate));
-
-        // Add action buttons
-        QWidget *actionWidget = new QWidget();
-        QHBoxLayout *layout = new QHBoxLayout(actionWidget);
-
-        QPushButton *acceptButton = new QPushButton("Accept");
-        QPushButton *completeButton = new QPushButton("Complete");
-
-        acceptButton->setProperty("orderId", orderId);
-        acceptButton->setProperty("row", row);
-        completeButton->setProperty("orderId", orderId);
-        completeButton->setProperty("row", row);
-
-        acceptButton->setStyleSheet("background-color: #4CAF50; color: white; padding: 4px;");
-        completeButton->setStyleSheet("background-color: #2196F3; color: white; padding: 4px;");
-
-        // Disable buttons based on status
-        if (status == "preparing" || status == "completed") {
-            acceptButton->setEnabled(false);
+    int shop = shopId;
+    qint64 sinceSeq = ordersChangeSeq;
+    int generation = ordersGeneration;
+    changePollPending = true;
+
+    DatabaseManager::instance().runAsync([shop, sinceSeq]() {
+        DatabaseManager &db = DatabaseManager::instance();
+        ShopSnapshot snapshot;
+        snapshot.page.orders = db.getOrderChangesSince(shop, sinceSeq);
+        if (!snapshot.page.orders.isEmpty()) {
+            snapshot.stats = db.getShopStats(shop);
         }
-        if (status == "completed") {
-            completeButton->setEnabled(false);
+        return snapshot;
+    }).then(this, [this, generation](const ShopSnapshot &snapshot) {
+        changePollPending = false;
+        // A full reload since the poll started already reflects these changes
+        if (generation != ordersGeneration || snapshot.page.orders.isEmpty()) {
+            return;
         }
+        applyOrderChanges(snapshot.page.orders);
+
+        ui->pendingOrdersLabel->setText(QString("Pending: %1").arg(snapshot.stats.pendingOrders));
+        ui->preparingOrdersLabel->setText(QString("Preparing: %1").arg(snapshot.stats.preparingOrders));
+        ui->readyOrdersLabel->setText(QString("Completed: %1").arg(snapshot.stats.completedOrders));
+    });
+}
 
-        layout->addWidget(acceptButton);
-        layout->addWidget(completeButton);
-        layout->setContentsMargins(2, 2, 2, 2);
+void VendorWindow::applyOrderChanges(const QVector<OrderSummary> &changes)
+{
+    bool completed = false;
 
-        ui->ordersTable->setCellWidget(row, 6, actionWidget);
+    for (const auto& order : changes) {
+        ordersChangeSeq = qMax(ordersChangeSeq, order.changeSeq);
+        completed = completed || order.status == "completed";
 
-        // Connect buttons
-        connect(acceptButton, &QPushButton::clicked, this, &VendorWindow::onAcceptOrderClicked);
-        connect(completeButton, &QPushButton::clicked, this, &VendorWindow::onCompleteOrderClicked);
+        if (orderBoard->updateOrder(order)) {
+            continue;
+        }
+        if (order.id > newestOrderId) {
+            // New order; older ones not yet paged in arrive with Load More
+            orderBoard->prependOrder(order);
+            newestOrderId = order.id;
+        }
     }
 
-    // Update order statistics
-    ui->pendingOrdersLabel->setText(QString("Pending: %1").arg(pendingCount));
-    ui->preparingOrdersLabel->setText(QString("Preparing: %1").arg(preparingCount));
-    ui->readyOrdersLabel->setText(QString("Completed: %1").arg(completedCount));
+    if (completed) {
+        loadFinancialData();
+    }
 }
 
 void VendorWindow::loadFinancialData()
@@ -399,37 +634,63 @@ void VendorWindow::loadFinancialData()
         ui->todayRevenueLabel->setText("Today's Revenue: ₹0.00");
         ui->totalOrdersLabel->setText("Total Orders: 0");
         ui->completedOrdersLabel->setText("Completed Orders: 0");
+        ui->loadMorePaymentsButton->setEnabled(false);
         return;
     }
 
-    double totalRevenue = DatabaseManager::instance().getTotalRevenue(shopId);
-    double todayRevenue = DatabaseManager::instance().getTodayRevenue(shopId);
-    int totalOrders = DatabaseManager::instance().getTotalOrdersCount(shopId);
-    int completedOrders = DatabaseManager::instance().getCompletedOrdersCount(shopId);
-
-    ui->totalRevenueLabel->setText(QString("Total Revenue: ₹%1").arg(totalRevenue, 0, 'f', 2));
-    ui->todayRevenueLabel->setText(QString("Today's Revenue: ₹%1").arg(todayRevenue, 0, 'f', 2));
-    ui->totalOrdersLabel->setText(QString("Total Orders: %1").arg(totalOrders));
-    ui->completedOrdersLabel->setText(QString("Completed Orders: %1").arg(completedOrders));
-
-    // Load payment history (completed orders)
-    auto orders = DatabaseManager::instance().getOrdersByShop(shopId);
-    ui->paymentHistoryTable->setRowCount(0);
-
-    int historyCount = 0;
-    for (const auto& order : orders) {
-        if (order[3].toString() == "completed") {
-            int row = ui->paymentHistoryTable->rowCount();
-            ui->paymentHistoryTable->insertRow(row);
-
-            QDateTime orderDateTime = order[4].toDateTime();
-            ui->paymentHistoryTable->setItem(row, 0, new QTableWidgetItem(orderDateTime.toString("yyyy-MM-dd")));
-            ui->paymentHistoryTable->setItem(row, 1, new QTableWidgetItem(order[0].toString()));
-            ui->paymentHistoryTable->setItem(row, 2, new QTableWidgetItem(QString("₹%1").arg(order[2].toDouble(), 0, 'f', 2)));
-            ui->paymentHistoryTable->setItem(row, 3, new QTableWidgetItem("Completed"));
-
-            historyCount++;
-            if (historyCount >= 10) break; // Show only last 10
+    paymentsCursor = OrderCursor();
+    fetchPaymentsPage(false);
+}
+
+void VendorWindow::onLoadMorePaymentsClicked()
+{
+    fetchPaymentsPage(true);
+}
+
+void VendorWindow::fetchPaymentsPage(bool append)
+{
+    int shop = shopId;
+    OrderCursor cursor = paymentsCursor;
+    int generation = append ? financeGeneration : ++financeGeneration;
+    ui->loadMorePaymentsButton->setEnabled(false);
+
+    DatabaseManager::instance().runAsync([shop, cursor]() {
+        DatabaseManager &db = DatabaseManager::instance();
+        ShopSnapshot snapshot;
+        snapshot.stats = db.getShopStats(shop);
+        // Payment history reaches back into archived orders
+        snapshot.page = db.getOrdersByShopPage(shop, cursor, kPaymentsPageSize, "completed", true);
+        return snapshot;
+    }).then(this, [this, generation, append](const ShopSnapshot &snapshot) {
+        if (generation != financeGeneration) {
+            return;
         }
+        paymentsCursor = snapshot.page.next;
+        ui->loadMorePaymentsButton->setEnabled(snapshot.page.hasMore);
+        showFinancialData(snapshot, append);
+    });
+}
+
+void VendorWindow::showFinancialData(const ShopSnapshot &snapshot, bool append)
+{
+    const ShopStats &stats = snapshot.stats;
+    ui->totalRevenueLabel->setText(QString("Total Revenue: ₹%1").arg(stats.totalRevenue, 0, 'f', 2));
+    ui->todayRevenueLabel->setText(QString("Today's Revenue: ₹%1").arg(stats.todayRevenue, 0, 'f', 2));
+    ui->totalOrdersLabel->setText(QString("Total Orders: %1").arg(stats.totalOrders));
+    ui->completedOrdersLabel->setText(QString("Completed Orders: %1").arg(stats.completedOrders));
+
+    // Payment history (completed orders, newest first)
+    if (!append) {
+        ui->paymentHistoryTable->setRowCount(0);
+    }
+
+    for (const auto& order : snapshot.page.orders) {
+        int row = ui->paymentHistoryTable->rowCount();
+        ui->paymentHistoryTable->insertRow(row);
+
+        ui->paymentHistoryTable->setItem(row, 0, new QTableWidgetItem(order.orderDate.toString("yyyy-MM-dd")));
+        ui->paymentHistoryTable->setItem(row, 1, new QTableWidgetItem(QString::number(order.id)));
+        ui->paymentHistoryTable->setItem(row, 2, new QTableWidgetItem(QString("₹%1").arg(order.totalAmount, 0, 'f', 2)));
+        ui->paymentHistoryTable->setItem(row, 3, new QTableWidgetItem("Completed"));
     }
 }
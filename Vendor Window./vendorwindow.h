@@ -2,11 +2,21 @@
 #define VENDORWINDOW_H
 
 #include <QMainWindow>
+#include "databasemanager.h"
+
+class QTimer;
+class OrderBoardModel;
 
 namespace Ui {
 class vendorwindow;
 }
 
+struct ShopSnapshot {
+    ShopStats stats;
+    OrderPage page;
+    qint64 changeSeq = 0;
+};
+
 class VendorWindow : public QMainWindow
 {
     Q_OBJECT
@@ -19,23 +29,45 @@ private slots:
     void on_logoutButton_clicked();
     void on_registerShopButton_clicked();
     void on_addProductButton_clicked();
-    void onAcceptOrderClicked();
-    void onCompleteOrderClicked();
+    void onImportProductsClicked();
+    void onExportOrdersClicked();
+    void onAcceptOrderClicked(int orderId);
+    void onCompleteOrderClicked(int orderId);
     void onRemoveProductClicked();
+    void onLoadMoreOrdersClicked();
+    void onLoadMorePaymentsClicked();
+    void pollOrderChanges();
 
 private:
     Ui::vendorwindow *ui;
     int vendorId;
     QString username;
     int shopId;
+    int productsGeneration = 0;
+    int ordersGeneration = 0;
+    int financeGeneration = 0;
+    OrderCursor ordersCursor;
+    OrderCursor paymentsCursor;
+    QTimer *changePollTimer;
+    qint64 ordersChangeSeq = 0;
+    bool changePollPending = false;
+    int newestOrderId = 0;
+    OrderBoardModel *orderBoard;
 
     void setupUI();
     void loadMyProducts();
+    void showMyProducts(const QVector<Product> &products);
+    void setOrderStatus(int orderId, const QString &status, const QString &message);
     void loadOrders();
+    void fetchOrdersPage(bool append);
+    void applyOrderChanges(const QVector<OrderSummary> &changes);
     void loadFinancialData();
+    void fetchPaymentsPage(bool append);
+    void showFinancialData(const ShopSnapshot &snapshot, bool append);
     bool validateShopRegistration();
     bool validateProductInput();
     void checkShopRegistration();
+    void showShop(const QString &shopName);
 };
 
 #endif
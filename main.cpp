@@ -4,13 +4,19 @@
 #include <QFont>
 #include <QDebug>
 #include "databasemanager.h"
+#include "startuptrace.h"
+#include "querytrace.h"
+#include "orderprotocol.h"
 #include "logindialog.h"
 #include "studentwindow.h"
 #include "vendorwindow.h"
 
 int main(int argc, char *argv[])
 {
+    StartupTrace::begin(argc, argv);
+    QueryTrace::configureFromEnvironment();
     QApplication app(argc, argv);
+    StartupTrace::mark("application created");
 
     // Set application font
     QFont appFont("Segoe UI", 9);
@@ -21,17 +27,40 @@ int main(int argc, char *argv[])
     app.setApplicationVersion("1.0");
     app.setOrganizationName("CEG");
 
-    // Initialize database
-    qDebug() << "Initializing database...";
-    if (!DatabaseManager::instance().initializeDatabase()) {
-        QMessageBox::critical(nullptr, "Database Error",
-                              "Failed to initialize database!\n\n"
-                              "Please check if the application has write permissions "
-                              "or if another instance is running.");
-        return -1;
+    // Kiosks share one database through the order service; a single install opens the file itself
+    QString orderService = qEnvironmentVariable("CEG_ORDER_SERVICE");
+    if (app.arguments().contains("--order-service") || orderService == "1") {
+        orderService = OrderProtocol::kDefaultServerName;
+    }
+
+    if (!orderService.isEmpty()) {
+        qDebug() << "Connecting to order service" << orderService;
+        if (!DatabaseManager::instance().connectToOrderService(orderService)) {
+            QMessageBox::critical(nullptr, "Database Error",
+                                  "Cannot reach the order service!\n\n"
+                                  "Please check that orderservice is running on this machine.");
+            return -1;
+        }
+    } else {
+        // Initialize database
+        qDebug() << "Initializing database...";
+        if (!DatabaseManager::instance().initializeDatabase()) {
+            QMessageBox::critical(nullptr, "Database Error",
+                                  "Failed to initialize database!\n\n"
+                                  "Please check if the application has write permissions "
+                                  "or if another instance is running.");
+            return -1;
+        }
     }
 
     qDebug() << "Database initialized successfully";
+    StartupTrace::mark("database ready");
+
+    // Build the menu catalog while the login dialog is up
+    DatabaseManager::instance().async(&DatabaseManager::catalog);
+
+    // Keep only recent orders in the hot tables; check hourly
+    DatabaseManager::instance().startArchiving(30, 60 * 60 * 1000);
 
     LoginDialog loginDialog;
     QMainWindow *currentWindow = nullptr;
@@ -39,6 +68,7 @@ int main(int argc, char *argv[])
     QObject::connect(&loginDialog, &LoginDialog::loginSuccessful,
                      [&](int userId, const QString &userType, const QString &username) {
                          qDebug() << "Login successful - User:" << username << "Type:" << userType << "ID:" << userId;
+                         StartupTrace::mark("login accepted");
 
                          // Delete previous window if exists
                          if (currentWindow) {
@@ -69,9 +99,11 @@ int main(int argc, char *argv[])
                          }
                      });
 
+    StartupTrace::markOnFirstPaint(&loginDialog, "login dialog visible");
     loginDialog.show();
 
     int result = app.exec();
+    QueryTrace::dump();
 
     // Cleanup
     if (currentWindow) {
@@ -0,0 +1,78 @@
+#include "startuptrace.h"
+#include <QElapsedTimer>
+#include <QSet>
+#include <QByteArray>
+#include <QDebug>
+#include <QEvent>
+#include <QTimer>
+#include <QWidget>
+#include <cstring>
+
+namespace {
+
+bool traceEnabled = false;
+QElapsedTimer clock;
+qint64 lastMarkNs = 0;
+QSet<QByteArray> seen;
+
+// The filter sees the paint event before the widget handles it, so the mark is queued to run
+// after the paint has been flushed to the window
+class FirstPaintFilter : public QObject {
+public:
+    FirstPaintFilter(QWidget *widget, const char *milestone)
+        : QObject(widget), milestone(milestone) {}
+
+    bool eventFilter(QObject *watched, QEvent *event) override {
+        if (event->type() == QEvent::Paint) {
+            QByteArray name = milestone;
+            QTimer::singleShot(0, [name]() { StartupTrace::mark(name.constData()); });
+            watched->removeEventFilter(this);
+            deleteLater();
+        }
+        return false;
+    }
+
+private:
+    QByteArray milestone;
+};
+
+}
+
+namespace StartupTrace {
+
+void begin(int argc, char *argv[]) {
+    clock.start();
+    traceEnabled = qEnvironmentVariableIntValue("CEG_TRACE_STARTUP") != 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace-startup") == 0) {
+            traceEnabled = true;
+        }
+    }
+}
+
+bool enabled() {
+    return traceEnabled;
+}
+
+void mark(const char *milestone) {
+    if (!traceEnabled || seen.contains(milestone)) {
+        return;
+    }
+    seen.insert(milestone);
+
+    qint64 now = clock.nsecsElapsed();
+    qDebug().noquote() << QString("[startup] %1 ms (+%2 ms) %3")
+                              .arg(now / 1e6, 8, 'f', 1)
+                              .arg((now - lastMarkNs) / 1e6, 7, 'f', 1)
+                              .arg(milestone);
+    lastMarkNs = now;
+}
+
+void markOnFirstPaint(QWidget *widget, const char *milestone) {
+    if (!traceEnabled) {
+        return;
+    }
+    widget->installEventFilter(new FirstPaintFilter(widget, milestone));
+}
+
+}
@@ -0,0 +1,19 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+// Startup milestones timed from the top of main(). Enabled by --trace-startup or CEG_TRACE_STARTUP=1;
+// otherwise every call is a no-op.
+class QWidget;
+
+namespace StartupTrace {
+
+void begin(int argc, char *argv[]);
+bool enabled();
+// Prints the time since begin() and since the previous milestone; repeated milestones are ignored
+void mark(const char *milestone);
+// Marks the milestone once the widget has finished its first paint
+void markOnFirstPaint(QWidget *widget, const char *milestone);
+
+}
+
+#endif